@@ -0,0 +1,513 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  benchmark.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Benchmark harness for the parallel simplex: loads or generates a problem
+ *  once and runs scaling sweeps over threads, chunk and kernel variants.
+ * @language: C++
+ *
+ * @section Description
+ *  The initial tableau is kept as a snapshot and restored before every run, so
+ *  the input file is parsed only once per sweep. Each point of the grid runs a
+ *  number of warmups followed by the measured repetitions. The results report
+ *  the median time with a distribution-free 95% confidence interval, the strong
+ *  scaling efficiency against the smallest thread count of the grid and, with
+ *  --weak, the weak scaling efficiency on problems whose number of constraints
+ *  grows with the number of threads. The interval is the narrowest pair of
+ *  order statistics whose exact binomial coverage is at least 95%, reported as
+ *  ci_coverage; below 6 repetitions no pair reaches it, and the interval is
+ *  the minimum and the maximum, with their lower coverage.
+ *
+ * @subsection Compilation
+ *   To compile this file you need to run the following command:
+ *
+ *  g++ -Ofast benchmark.cpp solver.cpp result_cache.cpp simplex.cpp pivot_trace.cpp telemetry.cpp trace_events.cpp sync_stats.cpp roofline.cpp health.cpp flight_recorder.cpp metrics.cpp energy.cpp reference.cpp -fopenmp -Wall -o benchmark
+ *
+ * @subsection usage
+ *   ./benchmark (--file /PATH/MxN | --generate MxN) [options]
+ *
+ *   --density d          density of the generated constraint matrix (default 1)
+ *   --seed s             seed of the generated problem (default 1)
+ *   --threads 1,2,4      thread counts of the sweep (default 1)
+ *   --chunks 1,100       chunk sizes of the sweep (default 1)
+ *   --kernels a,b        row-update kernels of the sweep (default baseline)
+ *   --warmup n           warmup runs per point (default 1)
+ *   --reps n             measured runs per point (default 5)
+ *   --weak               weak scaling, M constraints per thread (needs --generate)
+ *   --replay trace       execute the pivots of a recorded trace in every run
+ *   --skip-search        with --replay, do not run the pricing and the ratio test
+ *   --sync-stats         one extra, instrumented run per point for the barrier
+ *                        wait and the load imbalance of every worksharing loop
+ *   --energy             read the package and DRAM RAPL counters around every measured run
+ *                        and report the mean joules per solve and per iteration
+ *   --energy-root dir    powercap tree to read (default /sys/class/powercap)
+ *   --json file          write the results as JSON
+ *   --csv file           write the results as CSV
+ *
+ *   Example of a sweep on a generated 1000x1000 problem:
+ *
+ *   ./benchmark --generate 1000x1000 --threads 1,2,4,8 --chunks 10,100 --kernels baseline,restrict --json out.json
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <unistd.h>
+
+#include "simplex.h"
+#include "telemetry.h"
+#include "sync_stats.h"
+#include "energy.h"
+
+/**
+ * Problem instance of the sweep, with the snapshot of its initial tableau.
+ */
+struct Instance {
+    double **snapshot = 0;
+    double **tableau = 0;
+    int nL = 0;
+    int nC = 0;
+};
+
+/**
+ * Measurements of one point of the grid.
+ */
+struct Bench_Point {
+    int threads;
+    int chunk;
+    int kernel;
+    int constraints;
+    int iterations;
+    double objective;
+    vector<double> times;
+    double median;
+    double ci_low;
+    double ci_high;
+    double ci_coverage;         // probability that the interval holds the median
+    double mean;
+    double strong_efficiency;
+    double weak_efficiency;
+    bool synced = false;
+    double sync_overhead = 0;
+    double imbalance[SYNC_COUNT];
+    string sync_json;
+    bool metered = false;
+    double joules[ENERGY_DOMAINS] = {};    // mean per solve
+};
+
+/**
+ * Split a comma separated list of integers.
+ * @param s
+ * @return
+ */
+static vector<int> int_list(const string& s) {
+    vector<int> vec;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) {
+        int value;
+        if (from_string<int>(value, item, dec)) vec.push_back(value);
+    }
+    return vec;
+}
+
+/**
+ * Split a comma separated list of kernel names.
+ * @param s
+ * @return
+ */
+static vector<int> kernel_list(const string& s) {
+    vector<int> vec;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) {
+        int kernel = kernel_from_name(item);
+        if (kernel < 0) {
+            cerr << "Unknown kernel " << item << endl;
+            exit(EXIT_FAILURE);
+        }
+        vec.push_back(kernel);
+    }
+    return vec;
+}
+
+/**
+ * Median and distribution-free 95% confidence interval of the median, taken
+ * from the order statistics of the sample. The ranks k and n + 1 - k (from 1)
+ * hold the median with probability 1 - 2 P(B < k), B ~ Binomial(n, 1/2); k is
+ * the largest one that reaches 95%, or 1 when none does (n < 6).
+ * @param p
+ */
+static void summarize(Bench_Point& p) {
+    vector<double> t = p.times;
+    sort(t.begin(), t.end());
+    int n = t.size(), k = 0;
+
+    p.median = n % 2 ? t[n / 2] : (t[n / 2 - 1] + t[n / 2]) / 2;
+
+    double term = pow(0.5, n), below = 0;
+    p.ci_coverage = 1 - 2 * term;
+    for (int j = 0; j + 1 <= n - j; j++) {
+        below += term;
+        if (1 - 2 * below < 0.95) break;
+        k = j + 1;
+        p.ci_coverage = 1 - 2 * below;
+        term *= (double) (n - j) / (j + 1);
+    }
+    k = max(k, 1);
+    p.ci_low = t[k - 1];
+    p.ci_high = t[n - k];
+
+    p.mean = 0;
+    for (int i = 0; i < n; i++) p.mean += t[i];
+    p.mean /= n;
+}
+
+/**
+ * Load the instance once, either from a file or from the generator.
+ * @param file
+ * @param constraints
+ * @param variables
+ * @param density
+ * @param seed
+ * @return
+ */
+static Instance load_instance(const string& file, int constraints, int variables, double density, unsigned seed) {
+    Instance inst;
+
+    if (file.size()) {
+        vector<char> path(file.begin(), file.end());
+        path.push_back('\0');
+        char *args[2] = {0, path.data()};
+        inst.snapshot = read_data(args, inst.nL, inst.nC);
+    } else
+        inst.snapshot = generate_problem(constraints, variables, density, seed, inst.nL, inst.nC);
+
+    inst.tableau = alocate_matrix(inst.nL, inst.nC);
+    return inst;
+}
+
+/**
+ * Run the warmups and repetitions of one point of the grid.
+ * @param inst
+ * @param p
+ * @param warmup
+ * @param reps
+ * @param opt pivot loop options, the chunk and the kernel come from the point
+ * @param sync_report add an instrumented run for the synchronization accounting
+ * @param energy when set, the energy of the measured runs is read
+ */
+static void run_point(Instance& inst, Bench_Point& p, int warmup, int reps, Simplex_Options opt, bool sync_report,
+                      const Energy_Meter *energy) {
+    struct timespec timeInit, timeEnd;
+    Energy_Sample before, after;
+
+    opt.chunk = p.chunk;
+    opt.kernel = p.kernel;
+
+    omp_set_num_threads(p.threads);
+
+    for (int r = 0; r < warmup + reps; r++) {
+        copy_matrix(inst.tableau, inst.snapshot, inst.nL, inst.nC);
+
+        if (clock_gettime(CLOCK_REALTIME, &timeInit)) {
+            perror("clock gettime");
+            exit(EXIT_FAILURE);
+        }
+
+        if (energy) before = energy->sample();
+
+        p.iterations = simplex(inst.tableau, inst.nL - 1, inst.nC - 1, opt);
+
+        if (clock_gettime(CLOCK_REALTIME, &timeEnd)) {
+            perror("clock gettime");
+            exit(EXIT_FAILURE);
+        }
+
+        if (r >= warmup) {
+            p.times.push_back(elapsed_seconds(timeInit, timeEnd));
+            if (energy) {
+                after = energy->sample();
+                Energy_Reading reading = energy->measure(before, after);
+                for (int d = 0; d < ENERGY_DOMAINS; d++) p.joules[d] += reading.joules[d] / reps;
+            }
+        }
+    }
+    p.metered = energy != 0;
+
+    p.objective = inst.tableau[inst.nL - 1][inst.nC - 1];
+    summarize(p);
+
+    if (sync_report) {
+        Sync_Stats stats;
+
+        copy_matrix(inst.tableau, inst.snapshot, inst.nL, inst.nC);
+        opt.sync_stats = &stats;
+
+        double start = omp_get_wtime();
+        simplex(inst.tableau, inst.nL - 1, inst.nC - 1, opt);
+        double wall = omp_get_wtime() - start;
+
+        p.synced = true;
+        p.sync_overhead = stats.overhead(wall);
+        for (int k = 0; k < SYNC_COUNT; k++) p.imbalance[k] = stats.imbalance(k);
+        p.sync_json = stats.json(wall);
+    }
+}
+
+/**
+ * Host configuration written with the results.
+ * @return a JSON object
+ */
+static string host_json() {
+    char hostname[256] = "unknown";
+    gethostname(hostname, sizeof (hostname) - 1);
+
+    string cpu = "unknown";
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            cpu = line.substr(line.find(':') + 2);
+            break;
+        }
+    }
+
+    const char *bind = getenv("OMP_PROC_BIND");
+    const char *places = getenv("OMP_PLACES");
+
+    ostringstream out;
+    out << "{\"hostname\": " << json_escape(hostname)
+        << ", \"cpu\": " << json_escape(cpu)
+        << ", \"online_cpus\": " << sysconf(_SC_NPROCESSORS_ONLN)
+        << ", \"omp_num_procs\": " << omp_get_num_procs()
+        << ", \"omp_proc_bind\": " << json_escape(bind ? bind : "")
+        << ", \"omp_places\": " << json_escape(places ? places : "")
+        << ", \"compiler\": " << json_escape(__VERSION__)
+        << ", \"timestamp\": " << time(0) << "}";
+    return out.str();
+}
+
+/**
+ * Write the results as JSON.
+ * @param name
+ * @param source
+ * @param points
+ * @param warmup
+ * @param reps
+ */
+static void write_json(const string& name, const string& source, vector<Bench_Point>& points, int warmup, int reps) {
+    ofstream out(name.c_str());
+    if (!out.is_open()) {
+        cerr << "Error opening file " << name << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    out.precision(9);
+    out << "{\n  \"host\": " << host_json() << ",\n";
+    out << "  \"problem\": " << json_escape(source) << ",\n";
+    out << "  \"warmup\": " << warmup << ",\n  \"reps\": " << reps << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t k = 0; k < points.size(); k++) {
+        Bench_Point& p = points[k];
+        out << "    {\"threads\": " << p.threads << ", \"chunk\": " << p.chunk
+            << ", \"kernel\": " << json_escape(kernel_name(p.kernel))
+            << ", \"constraints\": " << p.constraints
+            << ", \"iterations\": " << p.iterations << ", \"objective\": " << p.objective
+            << ", \"median\": " << p.median << ", \"ci_low\": " << p.ci_low << ", \"ci_high\": " << p.ci_high
+            << ", \"ci_coverage\": " << p.ci_coverage
+            << ", \"mean\": " << p.mean
+            << ", \"strong_efficiency\": " << p.strong_efficiency
+            << ", \"weak_efficiency\": " << p.weak_efficiency;
+        if (p.metered)
+            out << ", \"energy_package\": " << p.joules[ENERGY_PACKAGE] << ", \"energy_dram\": " << p.joules[ENERGY_DRAM]
+                << ", \"energy_per_iteration\": " << (p.joules[ENERGY_PACKAGE] + p.joules[ENERGY_DRAM]) / p.iterations;
+        if (p.synced) out << ", \"sync\": " << p.sync_json;
+        out << ", \"times\": [";
+        for (size_t r = 0; r < p.times.size(); r++)
+            out << (r ? ", " : "") << p.times[r];
+        out << "]}" << (k + 1 < points.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * Write the results as CSV.
+ * @param name
+ * @param points
+ */
+static void write_csv(const string& name, vector<Bench_Point>& points) {
+    ofstream out(name.c_str());
+    if (!out.is_open()) {
+        cerr << "Error opening file " << name << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    out.precision(9);
+    out << "threads,chunk,kernel,constraints,iterations,objective,median,ci_low,ci_high,ci_coverage,mean,strong_efficiency,weak_efficiency";
+    if (points.size() && points[0].metered) out << ",energy_package,energy_dram,energy_per_iteration";
+    if (points.size() && points[0].synced) {
+        out << ",sync_overhead";
+        for (int s = 0; s < SYNC_COUNT; s++) out << ",imbalance_" << sync_name(s);
+    }
+    out << "\n";
+    for (size_t k = 0; k < points.size(); k++) {
+        Bench_Point& p = points[k];
+        out << p.threads << "," << p.chunk << "," << kernel_name(p.kernel) << "," << p.constraints << ","
+            << p.iterations << "," << p.objective << "," << p.median << "," << p.ci_low << ","
+            << p.ci_high << "," << p.ci_coverage << "," << p.mean << "," << p.strong_efficiency << "," << p.weak_efficiency;
+        if (p.metered)
+            out << "," << p.joules[ENERGY_PACKAGE] << "," << p.joules[ENERGY_DRAM] << ","
+                << (p.joules[ENERGY_PACKAGE] + p.joules[ENERGY_DRAM]) / p.iterations;
+        if (p.synced) {
+            out << "," << p.sync_overhead;
+            for (int s = 0; s < SYNC_COUNT; s++) out << "," << p.imbalance[s];
+        }
+        out << "\n";
+    }
+}
+
+/**
+ * Main function of the benchmark harness
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char** argv) {
+    string file, json, csv, replay;
+    int constraints = 0, variables = 0, warmup = 1, reps = 5;
+    double density = 1.0;
+    unsigned seed = 1;
+    bool weak = false, skip_search = false, sync_report = false, measure_energy = false;
+    string energy_root = "/sys/class/powercap";
+    Energy_Meter energy;
+    vector<int> threads(1, 1), chunks(1, 1), kernels(1, KERNEL_BASELINE);
+    vector<Pivot> pivots;
+    Simplex_Options opt;
+
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        bool has_value = a + 1 < argc;
+
+        if (arg == "--weak") weak = true;
+        else if (arg == "--skip-search") skip_search = true;
+        else if (arg == "--sync-stats") sync_report = true;
+        else if (arg == "--energy") measure_energy = true;
+        else if (!has_value) {
+            cerr << "Missing value for " << arg << endl;
+            exit(EXIT_FAILURE);
+        } else if (arg == "--file") file = argv[++a];
+        else if (arg == "--generate") {
+            if (sscanf(argv[++a], "%dx%d", &constraints, &variables) != 2) {
+                cerr << "Invalid dimension " << argv[a] << endl;
+                exit(EXIT_FAILURE);
+            }
+        } else if (arg == "--density") from_string<double>(density, argv[++a], dec);
+        else if (arg == "--seed") from_string<unsigned>(seed, argv[++a], dec);
+        else if (arg == "--threads") threads = int_list(argv[++a]);
+        else if (arg == "--chunks") chunks = int_list(argv[++a]);
+        else if (arg == "--kernels") kernels = kernel_list(argv[++a]);
+        else if (arg == "--warmup") from_string<int>(warmup, argv[++a], dec);
+        else if (arg == "--reps") from_string<int>(reps, argv[++a], dec);
+        else if (arg == "--json") json = argv[++a];
+        else if (arg == "--csv") csv = argv[++a];
+        else if (arg == "--replay") replay = argv[++a];
+        else if (arg == "--energy-root") {
+            measure_energy = true;
+            energy_root = argv[++a];
+        } else {
+            cerr << "Unknown option " << arg << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((file.empty() && constraints <= 0) || threads.empty() || chunks.empty() || reps <= 0) {
+        cerr << "Usage: " << argv[0] << " (--file /PATH/MxN | --generate MxN) [options]" << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (reps < 6)
+        fprintf(stderr, "%d repetitions are too few for a 95%% interval of the median; the minimum and "
+                "the maximum cover it with probability %.1f%%\n", reps, 100 * (1 - 2 * pow(0.5, reps)));
+    if (weak && file.size()) {
+        cerr << "--weak needs a generated problem" << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (weak && replay.size()) {
+        cerr << "--replay needs a fixed problem" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (measure_energy && !energy.open(energy_root)) {
+        cerr << "No readable RAPL counters under " << energy_root << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    sort(threads.begin(), threads.end());
+
+    string source = file.size() ? file : to_string(constraints) + "x" + to_string(variables);
+
+    vector<Bench_Point> points;
+    Instance inst;
+    if (!weak) inst = load_instance(file, constraints, variables, density, seed);
+
+    if (replay.size()) {
+        int m, n;
+        if (!read_pivot_trace(replay, m, n, pivots) || m != inst.nL - 1 || n != inst.nC - 1) {
+            cerr << "Invalid pivot trace " << replay << endl;
+            exit(EXIT_FAILURE);
+        }
+        opt.replay = &pivots;
+        opt.replay_skip_search = skip_search;
+    }
+
+    for (size_t t = 0; t < threads.size(); t++) {
+        if (weak) inst = load_instance(file, constraints * threads[t], variables, density, seed);
+
+        for (size_t c = 0; c < chunks.size(); c++)
+            for (size_t k = 0; k < kernels.size(); k++) {
+                Bench_Point p;
+                p.threads = threads[t];
+                p.chunk = chunks[c];
+                p.kernel = kernels[k];
+                p.constraints = inst.nL - 1;
+                run_point(inst, p, warmup, reps, opt, sync_report, measure_energy ? &energy : 0);
+                points.push_back(p);
+
+                printf("%d %d %s %d %f %f %f %f", p.threads, p.chunk, kernel_name(p.kernel),
+                       p.iterations, p.objective, p.median, p.ci_low, p.ci_high);
+                if (p.metered)
+                    printf(" %f %f", p.joules[ENERGY_PACKAGE] + p.joules[ENERGY_DRAM],
+                           (p.joules[ENERGY_PACKAGE] + p.joules[ENERGY_DRAM]) / p.iterations);
+                printf("\n");
+            }
+
+        if (weak) {
+            delete_matrix(inst.snapshot, inst.nL);
+            delete_matrix(inst.tableau, inst.nL);
+        }
+    }
+
+    // Efficiencies against the smallest thread count with the same chunk and kernel.
+    for (size_t k = 0; k < points.size(); k++) {
+        Bench_Point& p = points[k];
+        Bench_Point& base = points[k % (chunks.size() * kernels.size())];
+        double speedup = base.median / p.median;
+        p.strong_efficiency = weak ? 0 : speedup * base.threads / p.threads;
+        p.weak_efficiency = weak ? speedup : 0;
+    }
+
+    if (json.size()) write_json(json, source, points, warmup, reps);
+    if (csv.size()) write_csv(csv, points);
+
+    if (!weak) {
+        delete_matrix(inst.snapshot, inst.nL);
+        delete_matrix(inst.tableau, inst.nL);
+    }
+}
@@ -0,0 +1,96 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  buffer_pool.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Size-class pool of contiguous tableau buffers.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <new>
+
+#include "buffer_pool.h"
+
+Buffer_Pool::~Buffer_Pool() {
+    for (int k = 0; k < CLASSES; k++)
+        for (size_t b = 0; b < free_list[k].size(); b++)
+            delete[] free_list[k][b];
+}
+
+/**
+ * Size class of a request: the smallest power of two of doubles that holds it.
+ * @param values
+ * @return the class, -1 when the request is too large
+ */
+int Buffer_Pool::size_class(size_t values) {
+    int k = MIN_CLASS;
+    while (k < CLASSES && ((size_t) 1 << k) < values) k++;
+    return k < CLASSES ? k : -1;
+}
+
+/**
+ * Buffer of at least 'values' doubles, with unspecified contents.
+ * @param values
+ * @return null when it can not be allocated
+ */
+double * Buffer_Pool::acquire(size_t values) {
+    int k = size_class(values);
+    if (k < 0) return 0;
+
+    {
+        lock_guard<mutex> guard(lock);
+        if (!free_list[k].empty()) {
+            double *buffer = free_list[k].back();
+            free_list[k].pop_back();
+            pooled -= sizeof (double) << k;
+            hits++;
+            return buffer;
+        }
+        misses++;
+    }
+    return new (nothrow) double[(size_t) 1 << k];
+}
+
+/**
+ * Give a buffer back to the pool.
+ * @param buffer
+ * @param values the size it was acquired with
+ */
+void Buffer_Pool::release(double *buffer, size_t values) {
+    int k = size_class(values);
+    if (!buffer || k < 0) return;
+
+    {
+        lock_guard<mutex> guard(lock);
+        if (pooled + (sizeof (double) << k) <= limit) {
+            free_list[k].push_back(buffer);
+            pooled += sizeof (double) << k;
+            return;
+        }
+    }
+    delete[] buffer;
+}
+
+size_t Buffer_Pool::pooled_bytes() const {
+    lock_guard<mutex> guard(lock);
+    return pooled;
+}
+
+/**
+ * One line summary of the pool.
+ * @return
+ */
+string Buffer_Pool::report() const {
+    lock_guard<mutex> guard(lock);
+    char line[256];
+
+    snprintf(line, sizeof (line), "buffer pool: %ld hits, %ld misses, %.1f MiB pooled of %.1f MiB",
+             hits, misses, pooled / 1048576.0, limit / 1048576.0);
+    return line;
+}
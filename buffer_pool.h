@@ -0,0 +1,57 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  buffer_pool.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Size-class pool of contiguous tableau buffers.
+ * @language: C++
+ *
+ * @section Description
+ *  Buffers are rounded up to a power of two of doubles (at least 4096) and
+ *  kept on a free list per size class when released, up to a limit of pooled
+ *  bytes; above it they are freed. A buffer that comes back from the pool has
+ *  its pages already faulted in, which is most of the setup cost of a medium
+ *  sized solve. The pool is thread safe.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Buffer_Pool {
+public:
+    explicit Buffer_Pool(size_t limit_bytes = (size_t) 1 << 30) : limit(limit_bytes) {}
+    ~Buffer_Pool();
+
+    double * acquire(size_t values);
+    void release(double *buffer, size_t values);
+
+    size_t pooled_bytes() const;
+    string report() const;
+
+    static const int MIN_CLASS = 12;
+    static const int CLASSES = 48;
+
+private:
+    static int size_class(size_t values);
+
+    mutable mutex lock;
+    vector<double *> free_list[CLASSES];
+    size_t pooled = 0;
+    size_t limit;
+    long hits = 0;
+    long misses = 0;
+};
+
+#endif
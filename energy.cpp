@@ -0,0 +1,165 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  energy.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Package and DRAM energy from the RAPL counters of the Linux powercap
+ *  interface.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <algorithm>
+#include <dirent.h>
+
+#include "energy.h"
+
+/**
+ * First line of a sysfs file.
+ * @param path
+ * @param value
+ * @return false if the file can not be read
+ */
+static bool read_line(const string& path, string& value) {
+    char buffer[256];
+    FILE *file = fopen(path.c_str(), "r");
+
+    if (!file) return false;
+    bool ok = fgets(buffer, sizeof (buffer), file) != 0;
+    fclose(file);
+
+    if (!ok) return false;
+    value = buffer;
+    while (value.size() && (value.back() == '\n' || value.back() == ' ')) value.pop_back();
+    return true;
+}
+
+/**
+ * Counter of a sysfs file.
+ * @param path
+ * @param value
+ * @return false if the file can not be read
+ */
+static bool read_counter(const string& path, unsigned long long& value) {
+    string line;
+    return read_line(path, line) && sscanf(line.c_str(), "%llu", &value) == 1;
+}
+
+/**
+ * Names of the RAPL zones directly under a directory, sorted.
+ * @param dir
+ * @return
+ */
+static vector<string> rapl_entries(const string& dir) {
+    vector<string> names;
+    DIR *d = opendir(dir.c_str());
+
+    if (!d) return names;
+    for (struct dirent *e = readdir(d); e; e = readdir(d)) {
+        string name = e->d_name;
+        if (name.compare(0, 10, "intel-rapl") == 0 || name.compare(0, 8, "amd-rapl") == 0)
+            names.push_back(name);
+    }
+    closedir(d);
+    sort(names.begin(), names.end());
+    return names;
+}
+
+/**
+ * Discover the package and DRAM zones of a powercap tree. Zones whose
+ * counter can not be read (the kernel restricts energy_uj to root) are left
+ * out.
+ * @param root
+ * @return false when no readable zone was found
+ */
+bool Energy_Meter::open(const string& root) {
+    vector<string> top = rapl_entries(root);
+
+    zones.clear();
+    for (size_t k = 0; k < top.size(); k++) {
+        // The kernel also links the subzones at the top level ("intel-rapl:0:0").
+        if (count(top[k].begin(), top[k].end(), ':') != 1) continue;
+
+        vector<string> dirs(1, root + "/" + top[k]);
+        vector<string> sub = rapl_entries(dirs[0]);
+        for (size_t s = 0; s < sub.size(); s++) dirs.push_back(dirs[0] + "/" + sub[s]);
+
+        for (size_t d = 0; d < dirs.size(); d++) {
+            Zone zone;
+            unsigned long long value;
+
+            zone.path = dirs[d];
+            if (!read_line(zone.path + "/name", zone.name)) continue;
+
+            if (zone.name.compare(0, 8, "package-") == 0) zone.domain = ENERGY_PACKAGE;
+            else if (zone.name == "dram") zone.domain = ENERGY_DRAM;
+            else continue;
+
+            if (!read_counter(zone.path + "/energy_uj", value)) continue;
+            if (!read_counter(zone.path + "/max_energy_range_uj", zone.range)) zone.range = 0;
+            zones.push_back(zone);
+        }
+    }
+    return is_open();
+}
+
+/**
+ * Whether some zone of a domain was found.
+ * @param domain
+ * @return
+ */
+bool Energy_Meter::has(int domain) const {
+    for (size_t k = 0; k < zones.size(); k++)
+        if (zones[k].domain == domain) return true;
+    return false;
+}
+
+/**
+ * Zones in use, for the reports.
+ * @return
+ */
+string Energy_Meter::describe() const {
+    string out;
+    for (size_t k = 0; k < zones.size(); k++)
+        out += (k ? ", " : "") + zones[k].path + " (" + zones[k].name + ")";
+    return out;
+}
+
+/**
+ * Read every zone.
+ * @return
+ */
+Energy_Sample Energy_Meter::sample() const {
+    Energy_Sample s;
+
+    s.uj.resize(zones.size());
+    for (size_t k = 0; k < zones.size(); k++)
+        if (!read_counter(zones[k].path + "/energy_uj", s.uj[k])) s.uj[k] = 0;
+    return s;
+}
+
+/**
+ * Energy of the interval between two samples, by domain.
+ * @param begin
+ * @param end
+ * @return
+ */
+Energy_Reading Energy_Meter::measure(const Energy_Sample& begin, const Energy_Sample& end) const {
+    Energy_Reading r;
+
+    for (size_t k = 0; k < zones.size() && k < begin.uj.size() && k < end.uj.size(); k++) {
+        unsigned long long delta;
+
+        if (end.uj[k] >= begin.uj[k]) delta = end.uj[k] - begin.uj[k];
+        else if (zones[k].range > begin.uj[k]) delta = zones[k].range - begin.uj[k] + end.uj[k];
+        else delta = 0;
+
+        r.joules[zones[k].domain] += delta * 1e-6;
+    }
+    return r;
+}
@@ -0,0 +1,84 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  energy.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Package and DRAM energy of a solve from the RAPL counters of the
+ *  Linux powercap interface.
+ * @language: C++
+ *
+ * @section Description
+ *  The meter scans the zones of a powercap tree (by default
+ *  /sys/class/powercap) whose directory name starts with "intel-rapl" or
+ *  "amd-rapl", and keeps the package zones ("package-N") and the DRAM
+ *  subzones ("dram"). Each zone is read from its energy_uj counter, in
+ *  microjoules, before and after the solve. The counter wraps around at
+ *  max_energy_range_uj; one wrap per measured interval is accounted.
+ *
+ *  The root is configurable, so a fake tree can stand in for the kernel one
+ *  where RAPL is missing or not readable:
+ *
+ *    root/intel-rapl:0/name                     package-0
+ *    root/intel-rapl:0/energy_uj                123456789
+ *    root/intel-rapl:0/max_energy_range_uj      262143328850
+ *    root/intel-rapl:0/intel-rapl:0:0/name      dram
+ *    root/intel-rapl:0/intel-rapl:0:0/energy_uj ...
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum Energy_Domain {
+    ENERGY_PACKAGE = 0,
+    ENERGY_DRAM,
+    ENERGY_DOMAINS
+};
+
+/**
+ * Counter values of every zone at one instant, in microjoules.
+ */
+struct Energy_Sample {
+    vector<unsigned long long> uj;
+};
+
+/**
+ * Energy of an interval, in joules.
+ */
+struct Energy_Reading {
+    double joules[ENERGY_DOMAINS] = {};
+
+    double total() const { return joules[ENERGY_PACKAGE] + joules[ENERGY_DRAM]; }
+};
+
+class Energy_Meter {
+public:
+    bool open(const string& root = "/sys/class/powercap");
+    bool is_open() const { return !zones.empty(); }
+    bool has(int domain) const;
+    string describe() const;
+
+    Energy_Sample sample() const;
+    Energy_Reading measure(const Energy_Sample& begin, const Energy_Sample& end) const;
+
+private:
+    struct Zone {
+        string path;
+        string name;
+        int domain;
+        unsigned long long range;
+    };
+
+    vector<Zone> zones;
+};
+
+#endif
@@ -0,0 +1,233 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  flight_recorder.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief In-process flight recorder of the last iterations of the pivot loop.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <omp.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+
+#include "flight_recorder.h"
+
+// Recorder dumped by the signal handlers.
+static Flight_Recorder * volatile active_recorder = 0;
+
+/**
+ * Async-signal-safe output buffer with its own number formatting.
+ */
+struct Dump_Buffer {
+    char data[512];
+    size_t size = 0;
+
+    void put(char c) {
+        if (size < sizeof (data)) data[size++] = c;
+    }
+
+    void put(const char *s) {
+        while (*s) put(*s++);
+    }
+
+    void put(long v) {
+        char digits[24];
+        int n = 0;
+        unsigned long u = v < 0 ? -(unsigned long) v : v;
+
+        if (v < 0) put('-');
+        do {
+            digits[n++] = '0' + u % 10;
+            u /= 10;
+        } while (u);
+        while (n) put(digits[--n]);
+    }
+
+    /**
+     * Scientific notation with 9 significant digits.
+     * @param v
+     */
+    void put(double v) {
+        if (isnan(v)) return put("nan");
+        if (isinf(v)) return put(v < 0 ? "-inf" : "inf");
+        if (v < 0) {
+            put('-');
+            v = -v;
+        }
+
+        int exponent = 0;
+        if (v != 0) {
+            while (v >= 10) { v /= 10; exponent++; }
+            while (v < 1) { v *= 10; exponent--; }
+        }
+
+        long mantissa = lround(v * 1e8);
+        if (mantissa >= 1000000000L) {
+            mantissa /= 10;
+            exponent++;
+        }
+
+        char digits[9];
+        for (int k = 8; k >= 0; k--) {
+            digits[k] = '0' + mantissa % 10;
+            mantissa /= 10;
+        }
+        put(digits[0]);
+        put('.');
+        for (int k = 1; k < 9; k++) put(digits[k]);
+        put('e');
+        put((long) exponent);
+    }
+
+    bool flush(int fd) {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = write(fd, data + done, size - done);
+            if (n <= 0) return false;
+            done += n;
+        }
+        size = 0;
+        return true;
+    }
+};
+
+Flight_Recorder::~Flight_Recorder() {
+    if (active_recorder == this) active_recorder = 0;
+}
+
+/**
+ * Enable the recorder.
+ * @param entries capacity of the ring
+ * @param name file the ring is dumped to, overwritten by every dump
+ */
+void Flight_Recorder::open(size_t entries, const string& name) {
+    capacity = entries;
+    ring.assign(capacity, Flight_Entry());
+    head.store(0);
+    strncpy(path, name.c_str(), sizeof (path) - 1);
+    origin = last = omp_get_wtime();
+}
+
+/**
+ * Dump the ring on SIGSEGV, SIGTERM and SIGUSR1.
+ */
+void Flight_Recorder::install() {
+    struct sigaction action;
+
+    active_recorder = this;
+    memset(&action, 0, sizeof (action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, 0);
+
+    action.sa_flags = SA_RESETHAND;
+    sigaction(SIGSEGV, &action, 0);
+    sigaction(SIGTERM, &action, 0);
+}
+
+/**
+ * Signal handler.
+ * @param sig
+ */
+void Flight_Recorder::on_signal(int sig) {
+    int saved = errno;
+    Flight_Recorder *recorder = active_recorder;
+
+    if (recorder)
+        recorder->dump(sig == SIGSEGV ? "SIGSEGV" : sig == SIGTERM ? "SIGTERM" : "SIGUSR1");
+
+    if (sig != SIGUSR1) raise(sig);
+    errno = saved;
+}
+
+/**
+ * Mark the start of a solve, the duration of the first iteration is measured
+ * from it.
+ */
+void Flight_Recorder::start() {
+    last = omp_get_wtime();
+}
+
+/**
+ * Record an iteration; the timing fields are filled in here.
+ * @param entry
+ */
+void Flight_Recorder::record(Flight_Entry& entry) {
+    double now = omp_get_wtime();
+    size_t h = head.load(memory_order_relaxed);
+
+    entry.time = now - origin;
+    entry.duration = now - last;
+    last = now;
+    ring[h % capacity] = entry;
+    head.store(h + 1, memory_order_release);
+}
+
+/**
+ * Write the ring to the dump file, oldest iteration first.
+ * @param reason
+ * @return false if the file can not be written
+ */
+bool Flight_Recorder::dump(const char *reason) const {
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    size_t h = head.load(memory_order_acquire);
+    size_t begin = h > capacity ? h - capacity : 0;
+    Dump_Buffer out;
+    bool ok;
+
+    out.put("# flight recorder: ");
+    out.put(reason);
+    out.put(", last ");
+    out.put((long) (h - begin));
+    out.put(" of ");
+    out.put((long) h);
+    out.put(" iterations\n");
+    out.put("iteration entering leaving pivot objective step time duration growth primal_residual dual_residual near_zero_pivots\n");
+    ok = out.flush(fd);
+
+    for (size_t k = begin; ok && k < h; k++) {
+        const Flight_Entry& e = ring[k % capacity];
+        out.put((long) e.iteration);
+        out.put(' ');
+        out.put((long) e.entering);
+        out.put(' ');
+        out.put((long) e.leaving);
+        out.put(' ');
+        out.put(e.pivot);
+        out.put(' ');
+        out.put(e.objective);
+        out.put(' ');
+        out.put(e.step);
+        out.put(' ');
+        out.put(e.time);
+        out.put(' ');
+        out.put(e.duration);
+        out.put(' ');
+        out.put(e.growth);
+        out.put(' ');
+        out.put(e.primal_residual);
+        out.put(' ');
+        out.put(e.dual_residual);
+        out.put(' ');
+        out.put(e.near_zero_pivots);
+        out.put('\n');
+        ok = out.flush(fd);
+    }
+
+    close(fd);
+    return ok;
+}
@@ -0,0 +1,79 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  flight_recorder.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief In-process flight recorder of the last iterations of the pivot loop.
+ * @language: C++
+ *
+ * @section Description
+ *  A fixed-size ring of the last iterations (pivot choice, pivot value,
+ *  objective, timing and the metrics of the last health check), written by the
+ *  thread that does the bookkeeping of each iteration; the iterations are
+ *  separated by barriers, so there is a single writer at a time and no lock.
+ *  The slot is written before the head is published with a release store.
+ *
+ *  The ring is dumped as text on unboundedness, on failed health checks and on
+ *  SIGSEGV, SIGTERM and SIGUSR1. The dump only uses open, write and close and
+ *  its own number formatting, so it can run inside a signal handler. After a
+ *  SIGSEGV or SIGTERM dump the default action of the signal is restored and the
+ *  signal raised again; SIGUSR1 only dumps.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct Flight_Entry {
+    int iteration;
+    int entering;
+    int leaving;
+    double pivot;
+    double objective;
+    double step;
+    double time;            // end of the iteration, seconds since open
+    double duration;        // seconds
+    double growth;          // last health check, 0 without monitor
+    double primal_residual;
+    double dual_residual;
+    long near_zero_pivots;
+};
+
+class Flight_Recorder {
+public:
+    Flight_Recorder() {}
+    ~Flight_Recorder();
+
+    void open(size_t capacity, const string& name);
+    bool enabled() const { return capacity > 0; }
+    void install();
+
+    void start();
+    void record(Flight_Entry& entry);
+    bool dump(const char *reason) const;
+
+private:
+    static void on_signal(int sig);
+
+    vector<Flight_Entry> ring;
+    size_t capacity = 0;
+    atomic<size_t> head{0};
+    char path[4096] = "";
+    double origin = 0;
+    double last = 0;
+
+    Flight_Recorder(const Flight_Recorder&);
+    Flight_Recorder& operator=(const Flight_Recorder&);
+};
+
+#endif
@@ -0,0 +1,274 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  health.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Sampled numerical health checks of the pivot loop.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <algorithm>
+
+#include "health.h"
+#include "telemetry.h"
+
+/**
+ * Action mask from a comma separated list of "warn", "tighten" and "recompute".
+ * @param names
+ * @return the mask or -1 when a name is unknown
+ */
+int health_actions_from_names(const string& names) {
+    int actions = 0;
+    size_t begin = 0;
+
+    while (begin <= names.size()) {
+        size_t end = names.find(',', begin);
+        if (end == string::npos) end = names.size();
+        string name = names.substr(begin, end - begin);
+
+        if (name == "warn") actions |= HEALTH_WARN;
+        else if (name == "tighten") actions |= HEALTH_TIGHTEN;
+        else if (name == "recompute") actions |= HEALTH_RECOMPUTE;
+        else if (name != "none") return -1;
+        begin = end + 1;
+    }
+    return actions;
+}
+
+Health_Monitor::~Health_Monitor() {
+    delete_matrix(original, m + 1);
+    delete [] rows;
+}
+
+/**
+ * Enable the monitor.
+ * @param options
+ */
+void Health_Monitor::open(const Health_Options& options) {
+    opt = options;
+    state = opt.seed ? opt.seed : 1;
+}
+
+/**
+ * Snapshot the original data and reset the counters. Called before the
+ * first iteration of a solve.
+ * @param tableau
+ * @param constraintNumb
+ * @param colNumb
+ * @param tolerance pivot tolerance of the ratio test
+ */
+void Health_Monitor::start(double **tableau, int constraintNumb, int colNumb, double tolerance) {
+    if (original && (m != constraintNumb || width != colNumb)) {
+        delete_matrix(original, m + 1);
+        delete [] rows;
+        original = 0;
+    }
+    m = constraintNumb;
+    width = colNumb;
+    n = colNumb - constraintNumb;
+
+    if (!original) {
+        original = alocate_matrix(m + 1, width + 1);
+        rows = new int[m];
+    }
+    copy_matrix(original, tableau, m + 1, width + 1);
+
+    double largest = 0;
+    int misplaced = 0;
+
+#pragma omp parallel for reduction(max:largest) reduction(+:misplaced)
+    for (int i = 0; i <= m; i++) {
+        for (int j = 0; j <= width; j++)
+            largest = fmax(largest, fabs(original[i][j]));
+        for (int k = 0; k < m; k++)
+            if (original[i][n + k] != (i == k ? 1.0 : 0.0)) misplaced++;
+    }
+
+    for (int i = 0; i < m; i++) rows[i] = n + i;
+    scale = largest > 0 ? largest : 1;
+    residuals = misplaced == 0;
+    near_zero_checked = 0;
+    stats = Health_Metrics();
+    stats.tolerance = tolerance;
+
+    if (!residuals)
+        alarm("health: no slack identity block, residual checks disabled");
+}
+
+/**
+ * Account a pivot and update the basis. Called once per iteration.
+ * @param row leaving row
+ * @param col entering column
+ * @param pivot
+ */
+void Health_Monitor::pivot(int row, int col, double pivot) {
+    double magnitude = fabs(pivot);
+
+    stats.pivots++;
+    stats.min_pivot = min(stats.min_pivot, magnitude);
+    stats.max_pivot = max(stats.max_pivot, magnitude);
+    if (magnitude < opt.near_zero) stats.near_zero_pivots++;
+    rows[row] = col;
+}
+
+/**
+ * xorshift32 generator of the sampled subsets.
+ * @return
+ */
+unsigned Health_Monitor::next() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * Relative residual of an original constraint row at the current basic solution.
+ * @param tableau
+ * @param r
+ * @return
+ */
+double Health_Monitor::primal_residual(double **tableau, int r) const {
+    double ax = 0;
+    for (int i = 0; i < m; i++)
+        ax += original[r][rows[i]] * tableau[i][width];
+    return fabs(ax - original[r][width]) / (1 + fabs(original[r][width]));
+}
+
+/**
+ * Relative difference between the objective row entry of a column and its
+ * value recomputed from the original column.
+ * @param tableau
+ * @param j
+ * @return
+ */
+double Health_Monitor::dual_residual(double **tableau, int j) const {
+    double d = original[m][j];
+    for (int i = 0; i < m; i++)
+        d += tableau[m][n + i] * original[i][j];
+    return fabs(tableau[m][j] - d) / (1 + fabs(original[m][j]));
+}
+
+/**
+ * Sampled checks of the current tableau. Called by a single thread between
+ * iterations.
+ * @param tableau
+ * @param iteration
+ * @return the actions to take, 0 when every check passed
+ */
+int Health_Monitor::check(double **tableau, int iteration) {
+    double growth = 0, primal = 0, dual = 0;
+    int samples = min(opt.samples, m);
+
+    for (int s = 0; s < samples; s++) {
+        int r = next() % m;
+        for (int j = 0; j <= width; j++)
+            growth = max(growth, fabs(tableau[r][j]));
+        if (residuals) {
+            primal = max(primal, primal_residual(tableau, r));
+            dual = max(dual, dual_residual(tableau, next() % width));
+        }
+    }
+    if (residuals) dual = max(dual, dual_residual(tableau, width));
+    growth /= scale;
+
+    stats.checks++;
+    stats.growth = growth;
+    stats.primal_residual = primal;
+    stats.dual_residual = dual;
+    stats.max_growth = max(stats.max_growth, growth);
+    stats.max_primal_residual = max(stats.max_primal_residual, primal);
+    stats.max_dual_residual = max(stats.max_dual_residual, dual);
+
+    bool near_zero = stats.near_zero_pivots > near_zero_checked;
+    near_zero_checked = stats.near_zero_pivots;
+
+    if (!near_zero && growth <= opt.max_growth && primal <= opt.max_residual && dual <= opt.max_residual)
+        return 0;
+
+    stats.alarms++;
+    if (opt.actions & HEALTH_WARN) {
+        char line[256];
+        snprintf(line, sizeof (line),
+                 "health: iteration %d growth %.3e primal %.3e dual %.3e near-zero pivots %ld",
+                 iteration, growth, primal, dual, stats.near_zero_pivots);
+        alarm(line);
+    }
+    return opt.actions;
+}
+
+/**
+ * Raise the pivot tolerance of the ratio test.
+ * @param tolerance current tolerance
+ * @return the new tolerance
+ */
+double Health_Monitor::tighten(double tolerance) {
+    tolerance = tolerance > 0 ? max(tolerance, min(tolerance * 10, 1e-6)) : opt.near_zero;
+    stats.tightenings++;
+    stats.tolerance = tolerance;
+    return tolerance;
+}
+
+/**
+ * Rebuild the tableau of the current basis from the original data. Must be
+ * called outside of a parallel region.
+ * @param tableau
+ * @param kernel
+ * @return false when the basis is numerically singular; the tableau is then
+ *  left untouched
+ */
+bool Health_Monitor::recompute(double **tableau, int kernel) {
+    double **rebuilt = alocate_matrix(m + 1, width + 1);
+    vector<int> basis(rows, rows + m);
+    bool ok = refactor_basis(rebuilt, original, m, width, &basis[0], kernel);
+
+    if (ok) {
+        copy_matrix(tableau, rebuilt, m + 1, width + 1);
+        copy(basis.begin(), basis.end(), rows);
+        stats.recomputes++;
+    }
+    delete_matrix(rebuilt, m + 1);
+    return ok;
+}
+
+/**
+ * Human readable end-of-run report.
+ * @return
+ */
+string Health_Monitor::report() const {
+    char line[512];
+    snprintf(line, sizeof (line),
+             "health: %ld checks, %ld alarms, %ld near-zero pivots of %ld, pivot range [%.3e, %.3e], "
+             "max growth %.3e, max primal residual %.3e, max dual residual %.3e, "
+             "%ld tightenings (tolerance %.1e), %ld recomputes\n",
+             stats.checks, stats.alarms, stats.near_zero_pivots, stats.pivots,
+             stats.pivots ? stats.min_pivot : 0.0, stats.max_pivot, stats.max_growth,
+             stats.max_primal_residual, stats.max_dual_residual,
+             stats.tightenings, stats.tolerance, stats.recomputes);
+    return line;
+}
+
+/**
+ * Metrics as a JSON object.
+ * @return
+ */
+string Health_Monitor::json() const {
+    Json_Line line;
+    line.add("every", opt.every).add("checks", stats.checks).add("alarms", stats.alarms)
+        .add("pivots", stats.pivots).add("near_zero_pivots", stats.near_zero_pivots)
+        .add("min_pivot", stats.pivots ? stats.min_pivot : 0.0).add("max_pivot", stats.max_pivot)
+        .add("pivot_ratio", stats.pivots && stats.min_pivot > 0 ? stats.max_pivot / stats.min_pivot : 0.0)
+        .add("growth", stats.growth).add("max_growth", stats.max_growth)
+        .add("primal_residual", stats.primal_residual).add("dual_residual", stats.dual_residual)
+        .add("max_primal_residual", stats.max_primal_residual)
+        .add("max_dual_residual", stats.max_dual_residual)
+        .add("tightenings", stats.tightenings).add("tolerance", stats.tolerance)
+        .add("recomputes", stats.recomputes);
+    return line.str();
+}
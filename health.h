@@ -0,0 +1,134 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  health.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Sampled numerical health checks of the pivot loop.
+ * @language: C++
+ *
+ * @section Description
+ *  The monitor keeps a copy of the original tableau and the basis (the
+ *  variable of every row, the slack variables at the start). Every pivot
+ *  updates the pivot magnitude counters; one iteration out of 'every' it
+ *  checks, on random subsets of rows and columns:
+ *
+ *  - growth: largest entry of the sampled rows over the largest original entry;
+ *  - primal residual: |A x - b| of the sampled original rows, with x the basic
+ *    solution read from the independent values column;
+ *  - dual residual: difference between the reduced costs of the objective row
+ *    and -c + y A recomputed from the original columns, with y read from the
+ *    objective row at the slack columns. The objective value is always checked
+ *    as the independent values column.
+ *
+ *  Residuals are relative to 1 + |original value|. The ratio between the
+ *  largest and the smallest pivot magnitude is a cheap indicator of the
+ *  conditioning of the basis. The checks assume the identity block of the
+ *  slack variables of the input layout; without it only the pivot and growth
+ *  counters are kept.
+ *
+ *  The monitor prints nothing: the failed checks, the abandoned recomputes and
+ *  a missing slack identity block are given as one line each to the on_alarm
+ *  callback of the options, and the program decides where they go.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include <string>
+#include <math.h>
+
+#include "simplex.h"
+
+using namespace std;
+
+/**
+ * Actions taken when a check crosses a threshold, as a bit mask.
+ *  HEALTH_WARN gives the failed check to on_alarm.
+ *  HEALTH_TIGHTEN raises the pivot tolerance of the ratio test.
+ *  HEALTH_RECOMPUTE rebuilds the tableau of the current basis from the
+ *  original data at the end of the iteration.
+ */
+enum Health_Action {
+    HEALTH_WARN = 1,
+    HEALTH_TIGHTEN = 2,
+    HEALTH_RECOMPUTE = 4
+};
+
+struct Health_Options {
+    int every = 0;                  // check one iteration out of 'every', 0 disables the monitor
+    int samples = 16;               // rows and columns per check
+    double near_zero = 1e-9;        // pivot magnitude counted as near zero
+    double max_growth = 1e8;
+    double max_residual = 1e-6;
+    int actions = HEALTH_WARN;
+    unsigned seed = 1;
+    function<void(const string&)> on_alarm;     // one line per alarm, no newline
+};
+
+struct Health_Metrics {
+    long checks = 0;
+    long pivots = 0;
+    long near_zero_pivots = 0;
+    long alarms = 0;                // checks that crossed a threshold
+    long tightenings = 0;
+    long recomputes = 0;
+    double min_pivot = HUGE_VAL;    // magnitudes
+    double max_pivot = 0;
+    double growth = 0;              // last check
+    double max_growth = 0;
+    double primal_residual = 0;     // last check
+    double dual_residual = 0;
+    double max_primal_residual = 0;
+    double max_dual_residual = 0;
+    double tolerance = 0;           // current pivot tolerance of the ratio test
+};
+
+int health_actions_from_names(const string& names);
+
+class Health_Monitor {
+public:
+    Health_Monitor() {}
+    ~Health_Monitor();
+
+    void open(const Health_Options& options);
+    bool enabled() const { return opt.every > 0; }
+
+    void start(double **tableau, int constraintNumb, int colNumb, double tolerance);
+    void pivot(int row, int col, double pivot);
+    bool due(int iteration) const { return enabled() && iteration % opt.every == 0; }
+    int check(double **tableau, int iteration);
+    double tighten(double tolerance);
+    bool recompute(double **tableau, int kernel);
+    void alarm(const string& message) const { if (opt.on_alarm) opt.on_alarm(message); }
+
+    const Health_Metrics& metrics() const { return stats; }
+    const int * basis() const { return rows; }
+
+    string report() const;
+    string json() const;
+
+private:
+    unsigned next();
+    double primal_residual(double **tableau, int r) const;
+    double dual_residual(double **tableau, int j) const;
+
+    Health_Options opt;
+    Health_Metrics stats;
+    double **original = 0;
+    int *rows = 0;              // basic variable of every row
+    int m = 0, n = 0, width = 0;
+    double scale = 1;           // largest original magnitude
+    bool residuals = false;     // the slack identity block was found
+    long near_zero_checked = 0;
+    unsigned state = 1;
+
+    Health_Monitor(const Health_Monitor&);
+    Health_Monitor& operator=(const Health_Monitor&);
+};
+
+#endif
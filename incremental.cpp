@@ -0,0 +1,457 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  incremental.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Solved model that takes edits and re-optimizes from its basis.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstring>
+
+#include "incremental.h"
+
+static const double feasibility = 1e-9;
+
+/**
+ * Insert a zero column in every row.
+ * @param t
+ * @param rows
+ * @param cols current number of columns
+ * @param at
+ */
+static void insert_column(double **t, int rows, int cols, int at) {
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        double *row = new double[cols + 1];
+        memcpy(row, t[i], at * sizeof (double));
+        row[at] = 0.0;
+        memcpy(row + at + 1, t[i] + at, (cols - at) * sizeof (double));
+        delete [] t[i];
+        t[i] = row;
+    }
+}
+
+/**
+ * Remove a column from every row.
+ * @param t
+ * @param rows
+ * @param cols current number of columns
+ * @param at
+ */
+static void erase_column(double **t, int rows, int cols, int at) {
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; i++) {
+        double *row = new double[cols - 1];
+        memcpy(row, t[i], at * sizeof (double));
+        memcpy(row + at, t[i] + at + 1, (cols - at - 1) * sizeof (double));
+        delete [] t[i];
+        t[i] = row;
+    }
+}
+
+/**
+ * Insert a row.
+ * @param t
+ * @param rows current number of rows
+ * @param at
+ * @param row owned by the matrix afterwards
+ * @return the new array of row pointers
+ */
+static double ** insert_row(double **t, int rows, int at, double *row) {
+    double **grown = new double *[rows + 1];
+    copy(t, t + at, grown);
+    grown[at] = row;
+    copy(t + at, t + rows, grown + at + 1);
+    delete [] t;
+    return grown;
+}
+
+/**
+ * Remove a row.
+ * @param t
+ * @param rows current number of rows
+ * @param at
+ * @return the new array of row pointers
+ */
+static double ** erase_row(double **t, int rows, int at) {
+    double **shrunk = new double *[rows - 1];
+    delete [] t[at];
+    copy(t, t + at, shrunk);
+    copy(t + at + 1, t + rows, shrunk + at);
+    delete [] t;
+    return shrunk;
+}
+
+/**
+ * Model of a problem, not solved yet: the tableau is at the slack basis.
+ * @param problem
+ */
+Live_Model::Live_Model(const Problem& problem) : m(problem.constraints()), n(problem.variables()) {
+    current = alocate_matrix(m + 1, width() + 1);
+    original = alocate_matrix(m + 1, width() + 1);
+    copy_matrix(original, problem.tableau(), m + 1, width() + 1);
+    reset();
+}
+
+Live_Model::~Live_Model() {
+    delete_matrix(current, m + 1);
+    delete_matrix(original, m + 1);
+}
+
+/**
+ * Sign of the slack of a constraint in B^-1 e_i: -1 for a >= row, whose slack
+ * has coefficient -1, and 1 for the <= and = rows; the slack of an = row has
+ * coefficient 1 in the tableau and 0 in the original data.
+ * @param i
+ * @return
+ */
+double Live_Model::slack_sign(int i) const {
+    return original[i][n + i] < 0 ? -1.0 : 1.0;
+}
+
+/**
+ * Columns that may not enter the basis: the slacks of the = rows.
+ * @param fixed receives one flag per column
+ * @return whether there is one
+ */
+bool Live_Model::fixed_columns(vector<char>& fixed) const {
+    bool any = false;
+
+    fixed.assign(width(), 0);
+    for (int i = 0; i < m; i++)
+        if (original[i][n + i] == 0.0) fixed[n + i] = any = true;
+    return any;
+}
+
+/**
+ * Row where a column is basic.
+ * @param column
+ * @return -1 when it is not basic
+ */
+int Live_Model::basic_row(int column) const {
+    for (int r = 0; r < m; r++)
+        if (basis[r] == column) return r;
+    return -1;
+}
+
+void Live_Model::pivot(int row, int col) {
+    pivot_tableau(current, m, width(), row, col, opt.kernel);
+    basis[row] = col;
+}
+
+/**
+ * Back to the slack basis: the rows of the >= constraints are negated and the
+ * slacks of the = ones get coefficient 1, basic off zero until the first
+ * phase.
+ */
+void Live_Model::reset() {
+    int w = width();
+
+    copy_matrix(current, original, m + 1, w + 1);
+    basis.resize(m);
+    for (int r = 0; r < m; r++) {
+        basis[r] = n + r;
+        if (original[r][n + r] < 0)
+            for (int k = 0; k <= w; k++) current[r][k] = -current[r][k];
+        else if (original[r][n + r] == 0.0)
+            current[r][n + r] = 1.0;
+    }
+}
+
+/**
+ * Change the cost of a variable.
+ * @param j
+ * @param c
+ */
+void Live_Model::set_cost(int j, double c) {
+    double delta = c + original[m][j];
+    int r = basic_row(j), cols = width() + 1;
+
+    original[m][j] = -c;
+    if (r < 0) {
+        current[m][j] -= delta;
+        return;
+    }
+#pragma omp parallel for schedule(static)
+    for (int k = 0; k < cols; k++)
+        current[m][k] += delta * current[r][k];
+    current[m][j] = 0.0;
+}
+
+/**
+ * Change the independent value of a constraint.
+ * @param i
+ * @param b
+ */
+void Live_Model::set_bound(int i, double b) {
+    int w = width(), s = n + i;
+    double delta = (b - original[i][w]) * slack_sign(i);
+
+    original[i][w] = b;
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r <= m; r++)
+        current[r][w] += delta * current[r][s];
+}
+
+/**
+ * Add a constraint a x <= b with its slack, which is basic.
+ * @param a one coefficient per variable
+ * @param b
+ * @return the index of the constraint
+ */
+int Live_Model::add_constraint(const double *a, double b) {
+    int s = width(), cols = width() + 2;
+    vector<double> multiplier(m);
+
+    insert_column(current, m + 1, cols - 1, s);
+    insert_column(original, m + 1, cols - 1, s);
+
+    double *row = new double[cols], *data = new double[cols];
+    memset(data, 0, cols * sizeof (double));
+    memcpy(data, a, n * sizeof (double));
+    data[s] = 1.0;
+    data[cols - 1] = b;
+    memcpy(row, data, cols * sizeof (double));
+
+    // Eliminate the basic variables from the new row; only the structural
+    // ones can have a nonzero coefficient in it.
+    for (int r = 0; r < m; r++)
+        multiplier[r] = basis[r] < n ? data[basis[r]] : 0.0;
+
+#pragma omp parallel
+    {
+        int t = omp_get_thread_num(), team = omp_get_num_threads();
+        int first = (long) cols * t / team, last = (long) cols * (t + 1) / team;
+        for (int r = 0; r < m; r++) {
+            if (multiplier[r] == 0.0) continue;
+            for (int k = first; k < last; k++)
+                row[k] -= multiplier[r] * current[r][k];
+        }
+    }
+
+    current = insert_row(current, m + 1, m, row);
+    original = insert_row(original, m + 1, m, data);
+    basis.push_back(s);
+    return m++;
+}
+
+/**
+ * Add the constraint x_j <= u.
+ * @param j
+ * @param u
+ * @return the index of the constraint
+ */
+int Live_Model::add_upper_bound(int j, double u) {
+    vector<double> a(n, 0.0);
+    a[j] = 1.0;
+    return add_constraint(a.data(), u);
+}
+
+/**
+ * Add a variable with its column of coefficients and its cost; it is not
+ * basic.
+ * @param a one coefficient per constraint
+ * @param c
+ * @return the index of the variable
+ */
+int Live_Model::add_variable(const double *a, double c) {
+    vector<double> column(m + 1);
+    int cols = width() + 1;
+
+    // B^-1 a from the slack columns; the objective row gives -c + y a.
+    vector<double> sign(m);
+    for (int i = 0; i < m; i++) sign[i] = slack_sign(i) * a[i];
+#pragma omp parallel for schedule(static)
+    for (int r = 0; r <= m; r++) {
+        double sum = 0.0;
+        for (int i = 0; i < m; i++)
+            sum += current[r][n + i] * sign[i];
+        column[r] = sum;
+    }
+    column[m] -= c;
+
+    insert_column(current, m + 1, cols, n);
+    insert_column(original, m + 1, cols, n);
+    for (int r = 0; r <= m; r++) current[r][n] = column[r];
+    for (int i = 0; i < m; i++) original[i][n] = a[i];
+    original[m][n] = -c;
+
+    for (int r = 0; r < m; r++)
+        if (basis[r] >= n) basis[r]++;
+    return n++;
+}
+
+/**
+ * Remove a constraint. A nonbasic slack enters on the row of the primal
+ * ratio test, so the basis stays primal feasible when the column has a
+ * positive coefficient.
+ * @param i
+ */
+void Live_Model::remove_constraint(int i) {
+    int s = n + i, w = width(), r = basic_row(s);
+
+    if (r < 0) {
+        double best = HUGE_VAL, largest = 0;
+        for (int k = 0; k < m; k++)
+            if (current[k][s] > feasibility && current[k][w] / current[k][s] < best) {
+                best = current[k][w] / current[k][s];
+                r = k;
+            }
+        for (int k = 0; r < 0 && k < m; k++)
+            if (fabs(current[k][s]) > largest) {
+                largest = fabs(current[k][s]);
+                r = k;
+            }
+        pivot(r, s);
+    }
+
+    current = erase_row(current, m + 1, r);
+    original = erase_row(original, m + 1, i);
+    basis.erase(basis.begin() + r);
+    m--;
+    erase_column(current, m + 1, w + 1, s);
+    erase_column(original, m + 1, w + 1, s);
+    for (int k = 0; k < m; k++)
+        if (basis[k] > s) basis[k]--;
+}
+
+/**
+ * Remove a variable. A basic one leaves on the entering column of the dual
+ * ratio test, so the basis stays dual feasible when its row has a positive
+ * coefficient; otherwise the model goes back to the slack basis.
+ * @param j
+ */
+void Live_Model::remove_variable(int j) {
+    int w = width(), r = basic_row(j);
+    bool stuck = false;
+
+    if (r >= 0) {
+        vector<char> basic;
+        int k = -1;
+        double best = HUGE_VAL, largest = 0;
+
+        fixed_columns(basic);
+        for (int q = 0; q < m; q++) basic[basis[q]] = 1;
+        for (int c = 0; c < w; c++)
+            if (!basic[c] && current[r][c] > feasibility && current[m][c] / current[r][c] < best) {
+                best = current[m][c] / current[r][c];
+                k = c;
+            }
+        for (int c = 0; k < 0 && c < w; c++)
+            if (!basic[c] && fabs(current[r][c]) > largest) {
+                largest = fabs(current[r][c]);
+                k = c;
+            }
+        if (k >= 0 && fabs(current[r][k]) > feasibility) pivot(r, k);
+        else stuck = true;
+    }
+
+    erase_column(current, m + 1, w + 1, j);
+    erase_column(original, m + 1, w + 1, j);
+    n--;
+    if (stuck) {
+        reset();
+        return;
+    }
+    for (int k = 0; k < m; k++)
+        if (basis[k] > j) basis[k]--;
+}
+
+/**
+ * Solve from the current basis.
+ * @return
+ */
+Result Live_Model::reoptimize() {
+    Simplex_Status status = SIMPLEX_OPTIMAL;
+    Simplex_Options o = opt;
+    int w = width(), iterations = 0;
+    bool primal = true, dual = true, first = false;
+    double start = omp_get_wtime();
+    vector<char> fixed;
+
+    o.basis = basis.data();
+    o.status = &status;
+    o.cancel = &cancelled;
+    if (fixed_columns(fixed)) o.fixed = fixed.data();
+    // Round-off of the edits and of the first phase is not a pivot.
+    o.pivot_tolerance = std::max(o.pivot_tolerance, 1e-9);
+
+    for (int r = 0; r < m; r++) {
+        primal = primal && current[r][w] >= -feasibility;
+        first = first || (fixed[basis[r]] && fabs(current[r][w]) > feasibility);
+    }
+    for (int k = 0; k < w && dual; k++)
+        dual = fixed[k] || current[m][k] >= -feasibility;
+
+    if (first || (!primal && !dual)) {
+        // The slack of an = row is basic off zero, or the basis is neither
+        // primal nor dual feasible: the first phase, from the slack basis in
+        // the layout of the input.
+        copy_matrix(current, original, m + 1, w + 1);
+        iterations = phase_one(current, m, w, o, fixed.data());
+        if (status != SIMPLEX_OPTIMAL) {
+            reset();
+            cancelled = false;
+            return result(omp_get_wtime() - start, iterations, status, false);
+        }
+        if (o.max_iterations && iterations >= o.max_iterations) status = SIMPLEX_ITERATION_LIMIT;
+        else if (o.max_iterations) o.max_iterations -= iterations;
+    } else if (!primal) {
+        iterations = dual_simplex(current, m, w, o);
+        if (status != SIMPLEX_OPTIMAL) {
+            cancelled = false;
+            return result(omp_get_wtime() - start, iterations, status);
+        }
+    }
+
+    if (status == SIMPLEX_OPTIMAL)
+        iterations += simplex(current, m, w, o);
+    cancelled = false;
+    return result(omp_get_wtime() - start, iterations, status);
+}
+
+/**
+ * Result of the current tableau.
+ * @param seconds
+ * @param iterations
+ * @param status
+ * @param found false when the first phase found no feasible basis: no
+ *  solution is reported, as in Solver
+ * @return
+ */
+Result Live_Model::result(double seconds, int iterations, Simplex_Status status, bool found) const {
+    Result r;
+    int w = width();
+
+    r.status = status;
+    r.iterations = iterations;
+    r.time = seconds;
+    if (!found) {
+        r.x.assign(n, 0.0);
+        r.duals.assign(m, 0.0);
+        r.bound = r.gap = HUGE_VAL;
+        return r;
+    }
+    r.objective = current[m][w];
+    r.basis = basis;
+    r.x.assign(n, 0.0);
+    for (int i = 0; i < m; i++)
+        if (basis[i] < n) r.x[basis[i]] = current[i][w];
+    r.duals.resize(m);
+    for (int i = 0; i < m; i++) r.duals[i] = slack_sign(i) * current[m][n + i];
+    if (status == SIMPLEX_OPTIMAL) {
+        r.bound = r.objective;
+    } else if (status == SIMPLEX_UNBOUNDED || status == SIMPLEX_INFEASIBLE) {
+        r.bound = HUGE_VAL;
+    } else {
+        r.bound = objective_bound(current, original, m, w);
+    }
+    r.gap = r.bound - r.objective;
+    return r;
+}
@@ -0,0 +1,113 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  incremental.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Solved model that takes edits and re-optimizes from its basis.
+ * @language: C++
+ *
+ * @section Description
+ *  A Live_Model keeps the final tableau of its last solve, its basis and the
+ *  original data (the tableau of the slack basis). An edit updates both in
+ *  place with the smallest change that keeps the final tableau consistent
+ *  with its basis:
+ *
+ *  - cost c_j: the reduced cost of j, or the objective row by a multiple of
+ *    the row of j when it is basic; the basis stays primal feasible.
+ *  - bound b_i: the independent values by a multiple of the column of the
+ *    slack of i (B^-1 e_i); the basis stays dual feasible.
+ *  - new constraint: its row in the current basis, with its slack basic.
+ *  - new variable: its column in the current basis, B^-1 a and its reduced
+ *    cost from the duals.
+ *  - removed constraint: its slack enters the basis, if it is not basic, and
+ *    the row and the column are dropped.
+ *  - removed variable: it leaves the basis, if it is basic, and its column is
+ *    dropped.
+ *
+ *  reoptimize then runs the dual simplex when the basis is primal infeasible
+ *  and dual feasible, the parallel primal loop when it is primal feasible, and
+ *  when it is neither, phase_one from the slack basis, then the primal loop.
+ *  The slack coefficients of the original data give the senses as in
+ *  simplex.h, -1 for a >= row and 0 for an = row: the tableau holds the >=
+ *  rows negated and the slack of an = row with coefficient 1, fixed. While
+ *  such a slack is basic off zero, reoptimize also starts with phase_one.
+ *  Without a feasible basis, the result has no solution, as in Solver, and
+ *  the model goes back to the slack basis.
+ *  Bounds on a variable are constraints of the standard form
+ *  (add_upper_bound); the added rows are <= ones. Constraint i is always the
+ *  one with slack column variables() + i; removing one renumbers the
+ *  following ones. A cancelled reoptimize keeps its basis, and the next one
+ *  goes on from it.
+ *
+ *  Example:
+ *
+ *    Live_Model model(problem);
+ *    Result r = model.reoptimize();
+ *    model.set_bound(3, 120.0);
+ *    model.add_upper_bound(7, 10.0);
+ *    r = model.reoptimize();
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <vector>
+
+#include "solver.h"
+
+using namespace std;
+
+class Live_Model {
+public:
+    explicit Live_Model(const Problem& problem);
+    ~Live_Model();
+
+    void set_threads(int threads) { opt.threads = threads; }
+    void set_chunk(int chunk) { opt.chunk = chunk; }
+    void set_kernel(int kernel) { opt.kernel = kernel; }
+    void set_max_iterations(int iterations) { opt.max_iterations = iterations; }
+    void set_time_limit(double seconds) { opt.time_limit = seconds; }
+    void set_target(double objective) { opt.target = objective; }
+    void set_progress(const function<bool(const Simplex_Progress&)>& callback) { opt.on_progress = callback; }
+    void cancel() { cancelled = true; }
+
+    void set_cost(int j, double c);
+    void set_bound(int i, double b);
+    int add_constraint(const double *a, double b);
+    int add_upper_bound(int j, double u);
+    int add_variable(const double *a, double c);
+    void remove_constraint(int i);
+    void remove_variable(int j);
+
+    Result reoptimize();
+
+    int constraints() const { return m; }
+    int variables() const { return n; }
+    int width() const { return m + n; }
+    double ** tableau() const { return current; }
+
+private:
+    int basic_row(int column) const;
+    void pivot(int row, int col);
+    void reset();
+    double slack_sign(int i) const;
+    bool fixed_columns(vector<char>& fixed) const;
+    Result result(double seconds, int iterations, Simplex_Status status, bool found = true) const;
+
+    double **current = 0;       // tableau of the basis
+    double **original = 0;      // tableau of the slack basis
+    int m, n;
+    vector<int> basis;
+    Simplex_Options opt;
+    atomic<bool> cancelled{false};
+
+    Live_Model(const Live_Model&);
+    Live_Model& operator=(const Live_Model&);
+};
+
+#endif
@@ -0,0 +1,294 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  kernel_bench.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Microbenchmarks of the kernels of the pivot loop in isolation: row
+ *  update, pivot row normalization, pricing (argmax) and ratio test (argmin).
+ * @language: C++
+ *
+ * @section Description
+ *  Every kernel runs on a synthetic tableau inside a parallel region, exactly as
+ *  it is called by the solver, for a sweep of row widths, row counts, sparsity
+ *  and thread counts. The pivot row has a zero in the pivot column, so repeated
+ *  row updates keep the same multipliers and do the same work on every call.
+ *  For each point the benchmark reports ns/element, GB/s, GFLOP/s and the
+ *  percentage of the roofline estimate measured on the host for that number of
+ *  threads. Ratio test traffic counts one cache line per element read, since
+ *  the column accesses are strided. The bandwidth probe streams from memory, so
+ *  points above 100% have a working set that fits in cache.
+ *
+ * @subsection Compilation
+ *   To compile this file you need to run the following command:
+ *
+ *  g++ -Ofast kernel_bench.cpp solver.cpp result_cache.cpp simplex.cpp pivot_trace.cpp telemetry.cpp trace_events.cpp sync_stats.cpp roofline.cpp health.cpp flight_recorder.cpp metrics.cpp energy.cpp reference.cpp -fopenmp -Wall -o kernel_bench
+ *
+ * @subsection usage
+ *   ./kernel_bench [options]
+ *
+ *   --widths 1000,8000   row widths (default 4000)
+ *   --rows 1000          row counts (default 1000)
+ *   --sparsity 0,0.9     fraction of zero coefficients (default 0)
+ *   --threads 1,2,4      thread counts (default 1)
+ *   --chunk n            chunk size of the guided loops (default 100)
+ *   --reps n             kernel calls per trial (default 20)
+ *   --trials n           timed trials per point, the median is reported (default 5)
+ *   --csv file           write the results as CSV
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <random>
+
+#include "simplex.h"
+#include "roofline.h"
+
+const int CACHE_LINE = 64;
+
+enum Bench_Kernel {
+    BENCH_ELIMINATE_BASELINE = 0,
+    BENCH_ELIMINATE_RESTRICT,
+    BENCH_NORMALIZE,
+    BENCH_PRICING,
+    BENCH_RATIO,
+    BENCH_COUNT
+};
+
+static const char *bench_names[BENCH_COUNT] = {
+    "eliminate-baseline", "eliminate-restrict", "normalize", "pricing", "ratio"
+};
+
+/**
+ * Work done by one call of a kernel.
+ */
+struct Kernel_Work {
+    double elements;
+    double bytes;
+    double flops;
+};
+
+/**
+ * Split a comma separated list of numbers.
+ * @param s
+ * @return
+ */
+template <class T>
+static vector<T> number_list(const string& s) {
+    vector<T> vec;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) {
+        T value;
+        if (from_string<T>(value, item, dec)) vec.push_back(value);
+    }
+    return vec;
+}
+
+/**
+ * Synthetic tableau with 'rows' constraint rows plus the objective row.
+ * @param rows
+ * @param width
+ * @param sparsity
+ * @param col pivot column
+ * @param row pivot row
+ * @return
+ */
+static double ** synthetic_tableau(int rows, int width, double sparsity, int col, int row) {
+    double **tableau = alocate_matrix(rows + 1, width);
+    mt19937 gen(rows * 31 + width);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+
+    for (int i = 0; i <= rows; i++)
+        for (int j = 0; j < width; j++)
+            tableau[i][j] = unit(gen) < sparsity ? 0.0 : unit(gen) * 2.0 - 1.0;
+
+    for (int i = 0; i < rows; i++)
+        tableau[i][width - 1] = 1.0 + unit(gen);
+
+    tableau[row][col] = 0.0;
+    return tableau;
+}
+
+/**
+ * Bytes and FLOPs of one call of a kernel on the synthetic tableau.
+ * @param kernel
+ * @param tableau
+ * @param rows
+ * @param width
+ * @param col
+ * @param row
+ * @return
+ */
+static Kernel_Work kernel_work(int kernel, double **tableau, int rows, int width, int col, int row) {
+    Kernel_Work w;
+    double active = 0, positive = 0;
+
+    for (int i = 0; i < rows; i++) {
+        if (i != row && tableau[i][col] != 0.0) active++;
+        if (tableau[i][col] > 0.0) positive++;
+    }
+
+    switch (kernel) {
+        case BENCH_ELIMINATE_BASELINE:
+            active = rows - 1;
+            // fall through
+        case BENCH_ELIMINATE_RESTRICT:
+            w.elements = (double) rows * width;
+            w.bytes = active * width * 2 * sizeof (double) + width * sizeof (double);
+            w.flops = active * width * 2;
+            break;
+        case BENCH_NORMALIZE:
+            w.elements = width;
+            w.bytes = width * 2 * sizeof (double);
+            w.flops = width;
+            break;
+        case BENCH_PRICING:
+            w.elements = width;
+            w.bytes = width * sizeof (double);
+            w.flops = width;
+            break;
+        default:
+            w.elements = rows;
+            w.bytes = (double) rows * 2 * CACHE_LINE;
+            w.flops = positive;
+    }
+    return w;
+}
+
+/**
+ * Time 'reps' calls of a kernel inside one parallel region.
+ * @param kernel
+ * @param tableau
+ * @param rows
+ * @param width
+ * @param col
+ * @param row
+ * @param chunk
+ * @param reps
+ * @return seconds per call
+ */
+static double time_kernel(int kernel, double **tableau, int rows, int width, int col, int row, int chunk, int reps) {
+    struct Compare_Max max;
+    struct Compare_Min min;
+    int count = 0, updated = 0, colNumb = width - 1;
+
+    double start = omp_get_wtime();
+
+#pragma omp parallel default(none) shared(kernel,tableau,rows,colNumb,col,row,chunk,reps,max,min,count,updated)
+    for (int r = 0; r < reps; r++) {
+        switch (kernel) {
+            case BENCH_ELIMINATE_BASELINE:
+                eliminate_rows(tableau, rows, colNumb, row, col, KERNEL_BASELINE, updated);
+                break;
+            case BENCH_ELIMINATE_RESTRICT:
+                eliminate_rows(tableau, rows, colNumb, row, col, KERNEL_RESTRICT, updated);
+                break;
+            case BENCH_NORMALIZE:
+                normalize_pivot_row(tableau, colNumb, row, 1.0);
+                break;
+            case BENCH_PRICING:
+                pricing_argmax(tableau, rows, colNumb, chunk, max);
+                break;
+            default:
+                ratio_test_argmin(tableau, rows, colNumb, col, chunk, 0.0, min, count);
+        }
+#pragma omp barrier
+    }
+
+    return (omp_get_wtime() - start) / reps;
+}
+
+/**
+ * Main function of the kernel microbenchmarks
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char** argv) {
+    vector<int> widths(1, 4000), rows(1, 1000), threads(1, 1);
+    vector<double> sparsity(1, 0.0);
+    int chunk = 100, reps = 20, trials = 5;
+    string csv;
+
+    for (int a = 1; a + 1 < argc; a += 2) {
+        string opt = argv[a], value = argv[a + 1];
+
+        if (opt == "--widths") widths = number_list<int>(value);
+        else if (opt == "--rows") rows = number_list<int>(value);
+        else if (opt == "--sparsity") sparsity = number_list<double>(value);
+        else if (opt == "--threads") threads = number_list<int>(value);
+        else if (opt == "--chunk") from_string<int>(chunk, value, dec);
+        else if (opt == "--reps") from_string<int>(reps, value, dec);
+        else if (opt == "--trials") from_string<int>(trials, value, dec);
+        else if (opt == "--csv") csv = value;
+        else {
+            cerr << "Unknown option " << opt << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (argc % 2 == 0) {
+        cerr << "Missing value for " << argv[argc - 1] << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    ofstream out;
+    if (csv.size()) {
+        out.open(csv.c_str());
+        if (!out.is_open()) {
+            cerr << "Error opening file " << csv << endl;
+            exit(EXIT_FAILURE);
+        }
+        out << "kernel,threads,rows,width,sparsity,ns_per_element,gb_s,gflop_s,intensity,roof_gflop_s,roof_percent\n";
+    }
+
+    printf("%-20s %7s %7s %7s %8s %10s %9s %9s %9s %7s\n", "kernel", "threads", "rows", "width",
+           "sparsity", "ns/elem", "GB/s", "GFLOP/s", "roof", "%roof");
+
+    for (size_t t = 0; t < threads.size(); t++) {
+        omp_set_num_threads(threads[t]);
+        Roofline roof = measure_roofline();
+
+        printf("# %d threads: %.2f GB/s, %.2f GFLOP/s\n", threads[t], roof.bandwidth / 1e9, roof.flops / 1e9);
+
+        for (size_t r = 0; r < rows.size(); r++)
+            for (size_t w = 0; w < widths.size(); w++)
+                for (size_t s = 0; s < sparsity.size(); s++) {
+                    int col = widths[w] / 2, row = rows[r] / 2;
+                    double **tableau = synthetic_tableau(rows[r], widths[w], sparsity[s], col, row);
+
+                    for (int k = 0; k < BENCH_COUNT; k++) {
+                        Kernel_Work work = kernel_work(k, tableau, rows[r], widths[w], col, row);
+                        vector<double> times;
+
+                        time_kernel(k, tableau, rows[r], widths[w], col, row, chunk, 1);
+                        for (int i = 0; i < trials; i++)
+                            times.push_back(time_kernel(k, tableau, rows[r], widths[w], col, row, chunk, reps));
+                        sort(times.begin(), times.end());
+                        double time = times[times.size() / 2];
+
+                        double intensity = work.flops / work.bytes;
+                        double gflops = work.flops / time / 1e9;
+                        double roof_gflops = attainable_flops(roof, intensity) / 1e9;
+
+                        printf("%-20s %7d %7d %7d %8.3f %10.4f %9.3f %9.3f %9.3f %6.1f%%\n", bench_names[k],
+                               threads[t], rows[r], widths[w], sparsity[s], time * 1e9 / work.elements,
+                               work.bytes / time / 1e9, gflops, roof_gflops, 100.0 * gflops / roof_gflops);
+
+                        if (out.is_open())
+                            out << bench_names[k] << "," << threads[t] << "," << rows[r] << "," << widths[w] << ","
+                                << sparsity[s] << "," << time * 1e9 / work.elements << "," << work.bytes / time / 1e9
+                                << "," << gflops << "," << intensity << "," << roof_gflops << ","
+                                << 100.0 * gflops / roof_gflops << "\n";
+                    }
+
+                    delete_matrix(tableau, rows[r] + 1);
+                }
+    }
+}
@@ -0,0 +1,274 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  metrics.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Live metrics of a solve in Prometheus text format.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "metrics.h"
+#include "health.h"
+
+/**
+ * Resident set size of the process.
+ * @return bytes, 0 when unknown
+ */
+static double resident_bytes() {
+    long pages = 0, resident = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+
+    if (!statm) return 0;
+    if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(statm);
+    return (double) resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * Serve on a localhost TCP port.
+ * @param port
+ * @return false if the port can not be bound
+ */
+bool Metrics_Exporter::listen_port(int port) {
+    struct sockaddr_in addr;
+    int on = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof (on));
+
+    memset(&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(fd, (struct sockaddr *) &addr, sizeof (addr)) || listen(fd, 8)) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    return spawn();
+}
+
+/**
+ * Serve on a Unix socket. A stale socket file is replaced.
+ * @param path
+ * @return false if the socket can not be bound
+ */
+bool Metrics_Exporter::listen_unix(const string& path) {
+    struct sockaddr_un addr;
+
+    if (path.size() >= sizeof (addr.sun_path)) return false;
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+
+    memset(&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+
+    if (bind(fd, (struct sockaddr *) &addr, sizeof (addr)) || listen(fd, 8)) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    unix_path = path;
+    return spawn();
+}
+
+/**
+ * Start the sidecar thread.
+ * @return
+ */
+bool Metrics_Exporter::spawn() {
+    stopping = false;
+    worker = thread(&Metrics_Exporter::serve, this);
+    return true;
+}
+
+/**
+ * Stop the sidecar thread and release the socket.
+ */
+void Metrics_Exporter::close() {
+    if (fd < 0) return;
+    stopping = true;
+    if (worker.joinable()) worker.join();
+    ::close(fd);
+    fd = -1;
+    if (unix_path.size()) unlink(unix_path.c_str());
+    unix_path.clear();
+}
+
+/**
+ * Reset the metrics at the start of a solve.
+ * @param team
+ * @param m
+ * @param n
+ */
+void Metrics_Exporter::start(int team, int m, int n) {
+    threads.store(team, memory_order_relaxed);
+    constraints.store(m, memory_order_relaxed);
+    variables.store(n, memory_order_relaxed);
+    iterations.store(0, memory_order_relaxed);
+    objective.store(0, memory_order_relaxed);
+    for (int k = 0; k < PHASE_COUNT; k++) phase[k].store(0, memory_order_relaxed);
+    started.store(omp_get_wtime(), memory_order_relaxed);
+    finished.store(0, memory_order_relaxed);
+    running.store(true, memory_order_release);
+}
+
+/**
+ * Publish an iteration. Called by a single thread at a time.
+ * @param iteration number of iterations done
+ * @param value objective
+ * @param spent seconds spent in each phase by the calling thread in the
+ *  iteration, or 0 when the phases are not timed
+ */
+void Metrics_Exporter::iteration(int iteration, double value, const double *spent) {
+    if (spent)
+        for (int k = 0; k < PHASE_COUNT; k++)
+            phase[k].store(phase[k].load(memory_order_relaxed) + spent[k], memory_order_relaxed);
+    objective.store(value, memory_order_relaxed);
+    iterations.store(iteration, memory_order_release);
+}
+
+/**
+ * Publish the health counters. Called by a single thread at a time.
+ * @param h
+ */
+void Metrics_Exporter::health(const Health_Metrics& h) {
+    checks.store(h.checks, memory_order_relaxed);
+    alarms.store(h.alarms, memory_order_relaxed);
+    near_zero_pivots.store(h.near_zero_pivots, memory_order_relaxed);
+    tightenings.store(h.tightenings, memory_order_relaxed);
+    recomputes.store(h.recomputes, memory_order_relaxed);
+    growth.store(h.growth, memory_order_relaxed);
+    primal_residual.store(h.primal_residual, memory_order_relaxed);
+    dual_residual.store(h.dual_residual, memory_order_relaxed);
+}
+
+/**
+ * Mark the end of a solve.
+ */
+void Metrics_Exporter::finish() {
+    finished.store(omp_get_wtime(), memory_order_relaxed);
+    running.store(false, memory_order_release);
+}
+
+/**
+ * Prometheus text exposition of the current values.
+ * @return
+ */
+string Metrics_Exporter::render() const {
+    char line[256];
+    string out;
+    bool live = running.load(memory_order_acquire);
+    double begin = started.load(memory_order_relaxed);
+    double elapsed = begin > 0 ? (live ? omp_get_wtime() : finished.load(memory_order_relaxed)) - begin : 0;
+    long done = iterations.load(memory_order_acquire);
+
+    // Mean rate of the solve until the first one-second sample.
+    double per_second = rate_sampled ? rate : elapsed > 0 ? done / elapsed : 0;
+
+    struct Gauge {
+        const char *name;
+        const char *type;
+        const char *help;
+        double value;
+    } gauges[] = {
+        {"simplex_running", "gauge", "1 while a solve is in progress", (double) live},
+        {"simplex_threads", "gauge", "OpenMP threads of the solve", (double) threads.load(memory_order_relaxed)},
+        {"simplex_constraints", "gauge", "Constraints of the problem", (double) constraints.load(memory_order_relaxed)},
+        {"simplex_variables", "gauge", "Variables of the problem", (double) variables.load(memory_order_relaxed)},
+        {"simplex_iterations_total", "counter", "Iterations done", (double) done},
+        {"simplex_iterations_per_second", "gauge", "Iteration rate over the last second", per_second},
+        {"simplex_objective", "gauge", "Current objective value", objective.load(memory_order_relaxed)},
+        {"simplex_solve_seconds", "gauge", "Time since the start of the solve", elapsed},
+        {"simplex_resident_bytes", "gauge", "Resident set size of the process", resident_bytes()},
+        {"simplex_health_checks_total", "counter", "Numerical health checks", (double) checks.load(memory_order_relaxed)},
+        {"simplex_health_alarms_total", "counter", "Health checks that crossed a threshold", (double) alarms.load(memory_order_relaxed)},
+        {"simplex_health_near_zero_pivots_total", "counter", "Pivots below the near-zero threshold",
+            (double) near_zero_pivots.load(memory_order_relaxed)},
+        {"simplex_health_tightenings_total", "counter", "Pivot tolerance raises", (double) tightenings.load(memory_order_relaxed)},
+        {"simplex_health_recomputes_total", "counter", "Tableau rebuilds", (double) recomputes.load(memory_order_relaxed)},
+        {"simplex_health_growth", "gauge", "Growth factor at the last check", growth.load(memory_order_relaxed)},
+        {"simplex_health_primal_residual", "gauge", "Primal residual at the last check", primal_residual.load(memory_order_relaxed)},
+        {"simplex_health_dual_residual", "gauge", "Dual residual at the last check", dual_residual.load(memory_order_relaxed)},
+    };
+
+    for (size_t k = 0; k < sizeof (gauges) / sizeof (gauges[0]); k++) {
+        snprintf(line, sizeof (line), "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n",
+                 gauges[k].name, gauges[k].help, gauges[k].name, gauges[k].type, gauges[k].name, gauges[k].value);
+        out += line;
+    }
+
+    out += "# HELP simplex_phase_seconds_total Time spent in each phase of the pivot loop by the bookkeeping thread\n"
+           "# TYPE simplex_phase_seconds_total counter\n";
+    for (int k = 0; k < PHASE_COUNT; k++) {
+        snprintf(line, sizeof (line), "simplex_phase_seconds_total{phase=\"%s\"} %.17g\n",
+                 phase_name(k), phase[k].load(memory_order_relaxed));
+        out += line;
+    }
+    return out;
+}
+
+/**
+ * Sidecar loop: sample the iteration rate and answer the connections.
+ */
+void Metrics_Exporter::serve() {
+    double sampled = omp_get_wtime();
+    long last = iterations.load(memory_order_relaxed);
+
+    while (!stopping.load()) {
+        struct pollfd p = {fd, POLLIN, 0};
+        int ready = poll(&p, 1, 200);
+
+        double now = omp_get_wtime();
+        if (now - sampled >= 1.0) {
+            long it = iterations.load(memory_order_relaxed);
+            rate = it >= last ? (it - last) / (now - sampled) : 0;
+            rate_sampled = true;
+            last = it;
+            sampled = now;
+        }
+
+        if (ready <= 0 || !(p.revents & POLLIN)) continue;
+
+        int client = accept(fd, 0, 0);
+        if (client < 0) continue;
+
+        // The request is read and ignored: every path gets the metrics.
+        char request[1024];
+        struct pollfd c = {client, POLLIN, 0};
+        if (poll(&c, 1, 100) > 0) {
+            ssize_t n = recv(client, request, sizeof (request), 0);
+            (void) n;
+        }
+
+        string body = render();
+        string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+            + to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+
+        size_t done = 0;
+        while (done < response.size()) {
+            ssize_t n = send(client, response.data() + done, response.size() - done, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            done += n;
+        }
+        ::close(client);
+    }
+}
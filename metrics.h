@@ -0,0 +1,92 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  metrics.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Live metrics of a solve in Prometheus text format.
+ * @language: C++
+ *
+ * @section Description
+ *  The pivot loop publishes the iteration, the objective, the phase times and
+ *  the health counters with relaxed atomic stores from the bookkeeping of each
+ *  iteration; there is a single writer at a time, so no read-modify-write is
+ *  needed. A sidecar thread owns the listening socket (a Unix socket or a
+ *  localhost TCP port), samples the iteration rate once a second and answers
+ *  every connection with an HTTP response carrying the text exposition, e.g.
+ *
+ *    curl http://127.0.0.1:9100/metrics
+ *    curl --unix-socket /tmp/simplex.sock http://localhost/metrics
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "simplex.h"
+
+using namespace std;
+
+struct Health_Metrics;
+
+class Metrics_Exporter {
+public:
+    Metrics_Exporter() {}
+    ~Metrics_Exporter() { close(); }
+
+    bool listen_port(int port);
+    bool listen_unix(const string& path);
+    void close();
+    bool is_open() const { return fd >= 0; }
+
+    void start(int threads, int constraints, int variables);
+    void iteration(int iteration, double objective, const double *phase);
+    void health(const Health_Metrics& metrics);
+    void finish();
+
+    string render() const;
+
+private:
+    void serve();
+    bool spawn();
+
+    int fd = -1;
+    string unix_path;
+    thread worker;
+    atomic<bool> stopping{false};
+
+    atomic<int> threads{0};
+    atomic<int> constraints{0};
+    atomic<int> variables{0};
+    atomic<bool> running{false};
+    atomic<double> started{0};
+    atomic<double> finished{0};
+    atomic<long> iterations{0};
+    atomic<double> objective{0};
+    atomic<double> phase[PHASE_COUNT] = {};
+
+    atomic<long> checks{0};
+    atomic<long> alarms{0};
+    atomic<long> near_zero_pivots{0};
+    atomic<long> tightenings{0};
+    atomic<long> recomputes{0};
+    atomic<double> growth{0};
+    atomic<double> primal_residual{0};
+    atomic<double> dual_residual{0};
+
+    // Owned by the sidecar thread.
+    double rate = 0;
+    bool rate_sampled = false;
+
+    Metrics_Exporter(const Metrics_Exporter&);
+    Metrics_Exporter& operator=(const Metrics_Exporter&);
+};
+
+#endif
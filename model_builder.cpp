@@ -0,0 +1,158 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  model_builder.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Builder of problems from sparse coefficients, assembled directly in
+ *  the tableau without a text file.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include "model_builder.h"
+
+/**
+ * Reserve the storage of a model of known size.
+ * @param constraints
+ * @param variables
+ * @param nonzeros
+ */
+void Model_Builder::reserve(int constraints, int variables, size_t nonzeros) {
+    costs.reserve(variables);
+    bounds.reserve(constraints);
+    senses.reserve(constraints);
+    row_index.reserve(nonzeros);
+    col_index.reserve(nonzeros);
+    values.reserve(nonzeros);
+}
+
+/**
+ * Add a variable, x >= 0.
+ * @param cost its coefficient in the objective
+ * @return its index
+ */
+int Model_Builder::add_variable(double cost) {
+    costs.push_back(cost);
+    return costs.size() - 1;
+}
+
+/**
+ * Add a constraint, with no coefficients yet.
+ * @param sense
+ * @param rhs independent value
+ * @return its index
+ */
+int Model_Builder::add_constraint(Row_Sense sense, double rhs) {
+    bounds.push_back(rhs);
+    senses.push_back(sense);
+    return bounds.size() - 1;
+}
+
+/**
+ * Add a coefficient; the indexes are checked by build.
+ * @param row constraint
+ * @param col variable
+ * @param value
+ */
+void Model_Builder::add_coefficient(int row, int col, double value) {
+    row_index.push_back(row);
+    col_index.push_back(col);
+    values.push_back(value);
+}
+
+/**
+ * Add coefficients in triplet form.
+ * @param count
+ * @param rows
+ * @param cols
+ * @param values
+ */
+void Model_Builder::add_coefficients(size_t count, const int *rows, const int *cols, const double *values) {
+    row_index.insert(row_index.end(), rows, rows + count);
+    col_index.insert(col_index.end(), cols, cols + count);
+    this->values.insert(this->values.end(), values, values + count);
+}
+
+/**
+ * Assemble the tableau.
+ * @param problem receives the problem
+ * @return false when there is no constraint or variable, or a triplet is out
+ *  of range
+ */
+bool Model_Builder::build(Problem& problem) const {
+    int m = constraints(), n = variables();
+    long count = values.size(), bad = 0;
+
+    if (m == 0 || n == 0) return false;
+
+#pragma omp parallel for schedule(static) reduction(+:bad)
+    for (long k = 0; k < count; k++)
+        if (row_index[k] < 0 || row_index[k] >= m || col_index[k] < 0 || col_index[k] >= n) bad++;
+    if (bad) return false;
+
+    problem = Problem(m, n);
+    double **t = problem.tableau();
+    int w = problem.width(), team = omp_get_max_threads();
+    vector<long> offset((size_t) team * m, 0), start(m + 1);
+    vector<long> order(count);
+
+#pragma omp parallel num_threads(team)
+    {
+        int tid = omp_get_thread_num(), size = omp_get_num_threads();
+        long lo = count * tid / size, hi = count * (tid + 1) / size;
+        long *mine = offset.data() + (size_t) tid * m;
+
+        // Counting sort of the triplets by constraint: each thread counts and
+        // then places its own block, so a constraint keeps the input order.
+        for (long k = lo; k < hi; k++) mine[row_index[k]]++;
+
+#pragma omp barrier
+#pragma omp single
+        {
+            long at = 0;
+            for (int i = 0; i < m; i++) {
+                start[i] = at;
+                for (int s = 0; s < size; s++) {
+                    long c = offset[(size_t) s * m + i];
+                    offset[(size_t) s * m + i] = at;
+                    at += c;
+                }
+            }
+            start[m] = at;
+        }
+
+        for (long k = lo; k < hi; k++) order[mine[row_index[k]]++] = k;
+
+#pragma omp barrier
+#pragma omp for schedule(dynamic, 64)
+        for (int i = 0; i < m; i++) {
+            double *row = t[i];
+            for (long p = start[i]; p < start[i + 1]; p++)
+                row[col_index[order[p]]] += values[order[p]];
+            row[n + i] = senses[i] == ROW_LESS_EQUAL ? 1.0 : senses[i] == ROW_GREATER_EQUAL ? -1.0 : 0.0;
+            row[w] = bounds[i];
+        }
+
+#pragma omp for schedule(static) nowait
+        for (int j = 0; j < n; j++) t[m][j] = -costs[j];
+    }
+    return true;
+}
+
+/**
+ * Duals of the constraints, the rate of change of the optimal objective with
+ * their independent values, as the result has them.
+ * @param result result of the built problem
+ * @return one dual per constraint
+ */
+vector<double> Model_Builder::duals(const Result& result) const {
+    vector<double> y(constraints());
+
+    for (int i = 0; i < constraints() && i < (int) result.duals.size(); i++)
+        y[i] = result.duals[i];
+    return y;
+}
@@ -0,0 +1,81 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  model_builder.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Builder of problems from sparse coefficients, assembled directly in
+ *  the tableau without a text file.
+ * @language: C++
+ *
+ * @section Description
+ *  Variables and constraints are added with their costs and independent
+ *  values, the coefficients as (constraint, variable, value) triplets in any
+ *  order; repeated triplets add up. build assembles the tableau in parallel,
+ *  one row per constraint, with the sense in the coefficient of its slack: 1
+ *  for <=, -1 for >= and 0 for =, see simplex.h; the solver runs its first
+ *  phase when the slack basis is not feasible.
+ *
+ *  The triplets are bucketed by constraint with a counting sort of the team,
+ *  then every thread fills whole rows, so the sums do not depend on the
+ *  number of threads. The objective is maximized.
+ *
+ *  Example:
+ *
+ *    Model_Builder b;
+ *    int x = b.add_variable(3), y = b.add_variable(5);
+ *    int r = b.add_constraint(ROW_LESS_EQUAL, 4);
+ *    b.add_coefficient(r, x, 1);
+ *    r = b.add_constraint(ROW_GREATER_EQUAL, 2);
+ *    b.add_coefficient(r, x, 1); b.add_coefficient(r, y, 1);
+ *    Problem p;
+ *    if (b.build(p)) result = solver.solve(p);
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef MODEL_BUILDER_H
+#define MODEL_BUILDER_H
+
+#include <vector>
+
+#include "solver.h"
+
+using namespace std;
+
+enum Row_Sense {
+    ROW_LESS_EQUAL = 0,
+    ROW_GREATER_EQUAL,
+    ROW_EQUAL
+};
+
+class Model_Builder {
+public:
+    void reserve(int constraints, int variables, size_t nonzeros);
+
+    int add_variable(double cost);
+    int add_constraint(Row_Sense sense, double rhs);
+    void add_coefficient(int row, int col, double value);
+    void add_coefficients(size_t count, const int *rows, const int *cols, const double *values);
+    void set_cost(int col, double cost) { costs[col] = cost; }
+    void set_rhs(int row, double rhs) { bounds[row] = rhs; }
+
+    bool build(Problem& problem) const;
+    vector<double> duals(const Result& result) const;
+
+    int constraints() const { return bounds.size(); }
+    int variables() const { return costs.size(); }
+    size_t nonzeros() const { return values.size(); }
+
+private:
+    vector<double> costs;
+    vector<double> bounds;
+    vector<char> senses;
+    vector<int> row_index;
+    vector<int> col_index;
+    vector<double> values;
+};
+
+#endif
@@ -14,7 +14,9 @@
  * @section Description
  *  The current implementation uses the standard simplex algorithm in tabular 
  *  form to parallelize. The LP(Linear Programming) problem needs to be modeled 
- *  in the standard form and can not have artificial variables. 
+ *  in the standard form. When the slack variables are not a feasible basis, a 
+ *  first phase adds artificial variables internally and drives them out with 
+ *  the same pivot loop, see phase_one in simplex.cpp. 
  * 
  *  Standard form:
  *  maximize z = c^t * x,
@@ -32,18 +34,70 @@
  *  | A  b|
  *  |-c  0|
  *
+ *  The last columns of A are the slack variables, one per constraint: 1 in the 
+ *  row of the constraint for a <= one, -1 for a >= one and 0 for an = one. 
+ *  --verify only applies when the slack variables are a feasible basis. 
+ *
  * @subsection Compilation 
  *   To compile this file you need to run the following command:
  *
- *  g++ -Ofast simplexParallel.cpp -fopenmp -Wall -msse2 -fopt-info-vec-optimized  -ftree-vectorizer-verbose=2  -Wvector-operation-performance -o exec_name
+ *  g++ -Ofast parallelSimplex.cpp solver.cpp result_cache.cpp simplex.cpp pivot_trace.cpp telemetry.cpp trace_events.cpp sync_stats.cpp roofline.cpp health.cpp flight_recorder.cpp metrics.cpp energy.cpp reference.cpp -fopenmp -Wall -msse2 -fopt-info-vec-optimized  -ftree-vectorizer-verbose=2  -Wvector-operation-performance -o exec_name
  *
  * @subsection usage
  *   To run execute the command: 
  * 
- *   ./exec_name /PATH/name_of_input_file numb_of_threads chunk
+ *   ./exec_name /PATH/name_of_input_file numb_of_threads chunk [kernel] [options]
  *
  *   chunk is a positive integer that specifies a chunk size of a chunk-sized block of loop
  *   iterations to give to each thread.
+ *   kernel is the row-update kernel variant, "baseline" (default) or "restrict".
+ *   options:
+ *     --record trace_file    write the (entering, leaving) pair of every iteration
+ *     --replay trace_file    execute exactly the pivots of a recorded trace
+ *     --skip-search          with --replay, do not run the pricing and the ratio test
+ *     --log file             JSON-lines telemetry file, appended (default log_cpp.jsonl)
+ *     --log-iterations       also write one telemetry record per iteration
+ *     --no-log               do not write telemetry
+ *     --trace file           write the phases of every thread as Chrome trace-event JSON
+ *     --trace-every n        trace one iteration out of n (default 1)
+ *     --trace-events n       events kept per thread, the oldest are dropped (default 65536)
+ *     --sync-stats           report the wait, arrival skew and load imbalance of every barrier
+ *     --roofline             probe the host bandwidth and peak FLOP rate at startup and report
+ *                            the achieved GB/s, GFLOP/s and percent of roofline of each phase
+ *     --pivot-tolerance x    smallest coefficient accepted as a pivot by the ratio test (default 0)
+ *     --health n             check the numerical health one iteration out of n
+ *     --health-samples n     rows and columns sampled by each check (default 16)
+ *     --health-action list   comma separated actions on a failed check: warn (default),
+ *                            tighten, recompute or none
+ *     --health-max-growth x  growth factor threshold (default 1e8)
+ *     --health-max-residual x relative primal and dual residual threshold (default 1e-6)
+ *     --flight n             keep the last n iterations and dump them on unboundedness, failed
+ *                            health checks, SIGSEGV, SIGTERM and SIGUSR1
+ *     --flight-file file     flight recorder dump (default flight_recorder.txt)
+ *     --metrics-port n       serve live metrics in Prometheus text format on 127.0.0.1:n
+ *     --metrics-socket path  serve live metrics on a Unix socket
+ *     --energy               read the package and DRAM RAPL counters around the solve and
+ *                            append the joules per solve and per iteration to the output
+ *     --energy-root dir      powercap tree to read (default /sys/class/powercap)
+ *     --verify               solve again with the serial reference and compare the objective,
+ *                            the pivot sequence and the final tableau; exit status 2 on mismatch
+ *     --cache dir            keep the results in dir and return the stored one for an identical
+ *                            problem, or warm start from the basis of a problem of the same shape
+ *     --cache-mib n          size limit of the cache directory (default 1024)
+ *     --progress n           print the iteration, objective and elapsed time to stderr every n
+ *                            iterations
+ *     --max-iterations n     stop after n iterations
+ *     --time-limit s         stop after s seconds of solve
+ *     --target z             stop once the objective reaches z
+ *     --crash                start from a triangular crash basis with structural columns in
+ *                            place of slacks, when the slack basis is feasible; their number
+ *                            goes to stderr, 0 when too few to be worth applying
+ *   A solve stopped by a limit prints the solution of its last basis, which is feasible, and
+ *   reports the status and the gap to a bound of the optimal objective on stderr. When the
+ *   first phase is stopped before it finds a feasible basis, there is no solution: the status
+ *   goes to stderr and the exit status is 1, as for an infeasible or unbounded problem.
+ *   SIGINT stops the solve at the next iteration: the solution of the current basis, which is
+ *   feasible, is printed and the exit status is 3.
  *   The file's name needs to be like: number_of_constraintxnumber_of_variables.
  *   Example of a usage with a 2000x2000 LP problem, 16 threads and a chunk of 1000:
  * 
@@ -53,333 +107,357 @@
 // ----------------------------------------------------------------------------
 
 
-#include <stdlib.h>
+
+#include <csignal>
 #include <cstdio>
-#include <omp.h>
-#include <sstream>
 #include <iostream>
-#include <fstream>
-#include <vector>
-#include <math.h>
-#include <cstring>
-#include <string>
-
-#include "time.h"
-
 
-using namespace std;
-
-double **tableau;
-ofstream log_file;
-
-struct Compare_Max {
-    double val = 0;
-    int index = -1;
-};
-
-struct Compare_Min {
-    double val = HUGE_VAL;
-    int index = -1;
-};
-#pragma omp declare reduction(minimo : struct Compare_Min : omp_out = omp_in.val < omp_out.val ? omp_in : omp_out)
-#pragma omp declare reduction(maximo : struct Compare_Max : omp_out = omp_in.val > omp_out.val ? omp_in : omp_out)
+#include "solver.h"
+#include "telemetry.h"
+#include "trace_events.h"
+#include "sync_stats.h"
+#include "roofline.h"
+#include "health.h"
+#include "flight_recorder.h"
+#include "metrics.h"
+#include "energy.h"
+#include "reference.h"
+#include "result_cache.h"
+
+// Solver stopped by SIGINT.
+static Solver *running = 0;
+
+static void on_interrupt(int) {
+    if (running) running->cancel();
+}
 
 /**
- * Alocate matrix
- * @param nL
- * @param nC
- * @return a double pointer to pointer
+ * Main function where is implemented the parallel simplex
+ * @param argc
+ * @param argv
+ * @return 
  */
-double ** alocate_matrix(int nL, int nC) {
-
-    double **tableau = new (nothrow) double *[nL];
-
-    if (tableau == 0) {
-        cerr << "Not possible to alocate matrix\n";
+int main(int argc, char** argv) {
+    int numbThreads, constraintNumb, colNumb, ni = 0, chunk = 1;
+    int divergences = 0;
+    string input = argv[1], record, replay, log_name = "log_cpp.jsonl", trace_name;
+    int trace_every = 1, trace_events = 1 << 16;
+    bool log_iterations = false, sync_report = false, roofline = false;
+    vector<Pivot> recorded, replayed;
+    Input_Stats input_stats;
+    Telemetry telemetry;
+    Trace_Recorder trace;
+    Sync_Stats sync_stats;
+    Solve_Profile profile;
+    Roofline roof;
+    Health_Options health_options;
+    Health_Monitor health;
+    Flight_Recorder flight;
+    int flight_entries = 0;
+    string flight_name = "flight_recorder.txt";
+    Metrics_Exporter metrics;
+    int metrics_port = 0;
+    string metrics_socket;
+    Energy_Meter energy;
+    Energy_Sample energy_begin, energy_end;
+    Energy_Reading joules;
+    bool measure_energy = false;
+    string energy_root = "/sys/class/powercap";
+    bool verify = false, crash = false;
+    Result_Cache cache;
+    string cache_dir;
+    int cache_mib = 1024;
+    int progress_every = 0;
+    Problem lp, problem;
+    Solver solver;
+    Simplex_Options& opt = solver.options();
+    Result result;
+
+    struct timespec timeTotalInit, timeTotalEnd, timeReadInit;
+
+    if (clock_gettime(CLOCK_REALTIME, &timeReadInit)) {
+        perror("clock gettime");
         exit(EXIT_FAILURE);
     }
 
-    for (int i = 0; i < nL; i++) {
-        *(tableau + i) = new (nothrow) double[nC];
-        if ((tableau + i) == 0) {
-            cerr << "Not possible to alocate matrix \n";
-            exit(EXIT_FAILURE);
-        }
+    if (!lp.load(input, &input_stats)) {
+        cerr << "Error opening file";
+        exit(1);
     }
-    return tableau;
-}
-
-/**
- * Delete matrix
- * @param tableau
- * @param nL
- */
-void delete_matrix(double **tableau, int nL) {
-
-    if (tableau == 0) return;
 
-    for (int i = 0; i < nL; i++) {
+    constraintNumb = lp.constraints();
+    colNumb = lp.width();
 
-        delete [] tableau[i];
-    }
+    from_string<int>(numbThreads, string(argv[2]), std::dec);
 
-    delete [] tableau;
-}
+    omp_set_num_threads(numbThreads);
+    solver.set_threads(numbThreads);
 
-/**
- * Calculate the time spent between a start and a end timespec structure.
- * @param start
- * @param end
- * @return 
- */
-struct timespec My_diff(struct timespec start, struct timespec end) {
-    struct timespec temp;
-
-    if ((end.tv_nsec - start.tv_nsec) < 0) {
-        temp.tv_sec = end.tv_sec - start.tv_sec - 1;
-        temp.tv_nsec = 1000000000 + end.tv_nsec - start.tv_nsec;
-    } else {
-        temp.tv_sec = end.tv_sec - start.tv_sec;
-        temp.tv_nsec = end.tv_nsec - start.tv_nsec;
+    from_string<int>(chunk, string(argv[3]), std::dec);
+    opt.chunk = chunk;
+
+    for (int a = 4; a < argc; a++) {
+        string arg = argv[a];
+
+        if (arg == "--skip-search") opt.replay_skip_search = true;
+        else if (arg == "--log-iterations") log_iterations = true;
+        else if (arg == "--sync-stats") sync_report = true;
+        else if (arg == "--roofline") roofline = true;
+        else if (arg == "--energy") measure_energy = true;
+        else if (arg == "--verify") verify = true;
+        else if (arg == "--crash") crash = true;
+        else if (arg == "--cache" && a + 1 < argc) cache_dir = argv[++a];
+        else if (arg == "--cache-mib" && a + 1 < argc) from_string<int>(cache_mib, argv[++a], std::dec);
+        else if (arg == "--progress" && a + 1 < argc) from_string<int>(progress_every, argv[++a], std::dec);
+        else if (arg == "--max-iterations" && a + 1 < argc) from_string<int>(opt.max_iterations, argv[++a], std::dec);
+        else if (arg == "--time-limit" && a + 1 < argc) from_string<double>(opt.time_limit, argv[++a], std::dec);
+        else if (arg == "--target" && a + 1 < argc) from_string<double>(opt.target, argv[++a], std::dec);
+        else if (arg == "--energy-root" && a + 1 < argc) {
+            measure_energy = true;
+            energy_root = argv[++a];
+        }
+        else if (arg == "--no-log") log_name.clear();
+        else if (arg == "--log" && a + 1 < argc) log_name = argv[++a];
+        else if (arg == "--trace" && a + 1 < argc) trace_name = argv[++a];
+        else if (arg == "--trace-every" && a + 1 < argc) from_string<int>(trace_every, argv[++a], std::dec);
+        else if (arg == "--trace-events" && a + 1 < argc) from_string<int>(trace_events, argv[++a], std::dec);
+        else if (arg == "--record" && a + 1 < argc) record = argv[++a];
+        else if (arg == "--replay" && a + 1 < argc) replay = argv[++a];
+        else if (arg == "--pivot-tolerance" && a + 1 < argc) from_string<double>(opt.pivot_tolerance, argv[++a], std::dec);
+        else if (arg == "--health" && a + 1 < argc) from_string<int>(health_options.every, argv[++a], std::dec);
+        else if (arg == "--health-samples" && a + 1 < argc) from_string<int>(health_options.samples, argv[++a], std::dec);
+        else if (arg == "--metrics-port" && a + 1 < argc) from_string<int>(metrics_port, argv[++a], std::dec);
+        else if (arg == "--metrics-socket" && a + 1 < argc) metrics_socket = argv[++a];
+        else if (arg == "--flight" && a + 1 < argc) from_string<int>(flight_entries, argv[++a], std::dec);
+        else if (arg == "--flight-file" && a + 1 < argc) flight_name = argv[++a];
+        else if (arg == "--health-max-growth" && a + 1 < argc) from_string<double>(health_options.max_growth, argv[++a], std::dec);
+        else if (arg == "--health-max-residual" && a + 1 < argc) from_string<double>(health_options.max_residual, argv[++a], std::dec);
+        else if (arg == "--health-action" && a + 1 < argc) {
+            if ((health_options.actions = health_actions_from_names(argv[++a])) < 0) {
+                cerr << "Unknown health action " << argv[a] << endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if ((opt.kernel = kernel_from_name(arg)) < 0) {
+            cerr << "Unknown argument " << arg << endl;
+            exit(EXIT_FAILURE);
+        }
     }
-    return temp;
-}
 
-/**
- * Aux function to convert string to double
- * @param t
- * @param s
- * @param f
- * @return 
- */
-template <class T>
-bool from_string(T& t, const string& s, ios_base& (*f)(ios_base&)) {
-    istringstream iss(s);
-    return !(iss >> f >> t).fail();
-}
-
-/**
- * Function to convert the string line coefficients to double
- * @param s
- * @return 
- */
-template <class T>
-vector<T> string_to_vector(string s) {
-    istringstream iss(s);
-    vector<T> vec;
-    do {
-        string sub;
-        iss >> sub;
-        T numb;
-        if (from_string<T>(numb, sub, dec)) {
-            vec.push_back(numb);
+    if (crash) {
+        if (verify || record.size() || replay.size()) {
+            cerr << "--crash can not be combined with --verify, --record or --replay" << endl;
+            exit(EXIT_FAILURE);
         }
-    } while (iss);
-    return vec;
-}
-
-/**
- * Get the dimension of matrix from file name.
- * @param argv
- * @param nL
- * @param nC
- */
-void get_dimension(char** argv, int &nL, int &nC) {
-    int dimension[2] = {0, 0}, i = 0;
-
-    char *pch = strtok(argv[1], "x/_");
-    while (pch != NULL) {
+        solver.set_crash(true);
+    }
 
-        if (i == 1) {
-            dimension[0] = atoi(pch);
+    if (cache_dir.size()) {
+        if (verify || record.size() || replay.size()) {
+            cerr << "--cache can not be combined with --verify, --record or --replay" << endl;
+            exit(EXIT_FAILURE);
         }
-        if (i == 2) {
-            dimension[1] = atoi(pch);
+        if (!cache.open_disk(cache_dir, (size_t) cache_mib << 20)) {
+            cerr << "Error opening cache directory " << cache_dir << endl;
+            exit(EXIT_FAILURE);
         }
-        pch = strtok(NULL, "x/_");
-        i++;
+        solver.set_cache(&cache);
     }
-    nL = dimension[0] + 1;
-    nC = dimension[0] + dimension[1] + 1;
-}
-
-/**
- * Function to read from the file the information needed for simplex algorithm.
- * @param argv
- * @param nL
- * @param nC
- * @return 
- */
-double ** read_data(char** argv, int& nL, int& nC) {
 
-    ifstream file(argv[1]);
-
-    log_file.open("log_cpp", ofstream::app);
-
-    if (!file.is_open()) {
-        cerr << "Error opening file";
-        exit(1);
+    if (record.size() || verify) opt.record = &recorded;
+    if (replay.size()) {
+        int m, n;
+        if (!read_pivot_trace(replay, m, n, replayed) || m != constraintNumb || n != colNumb) {
+            cerr << "Invalid pivot trace " << replay << endl;
+            exit(EXIT_FAILURE);
+        }
+        opt.replay = &replayed;
+        opt.divergences = &divergences;
     }
 
-    get_dimension(argv, nL, nC);
-
-    log_file << "----" << nL << "x" << nC << "----" << endl << endl;
-
-    double ** tableau = alocate_matrix(nL, nC);
-
-    int lin = 0;
-    string line;
-    vector<int> sizes_col;
-    while (getline(file, line)) {
-
-        if (line == "") break;
-
-        vector<double> contraint = string_to_vector<double>(line);
-        copy(contraint.begin(), contraint.end(), tableau[lin]);
-        lin++;
-        sizes_col.push_back(contraint.size());
+    if (log_name.size()) {
+        if (!telemetry.open(log_name, log_iterations)) {
+            cerr << "Error opening log file " << log_name << endl;
+            exit(EXIT_FAILURE);
+        }
+        opt.telemetry = &telemetry;
     }
 
-    log_file << "lin " << lin << endl << "col:\n";
+    if (sync_report) opt.sync_stats = &sync_stats;
 
-    for (uint i = 0; i < sizes_col.size(); i++) {
-        log_file << i << " : " << sizes_col[i] << endl;
+    if (roofline) {
+        roof = measure_roofline();
+        opt.profile = &profile;
     }
 
+    if (health_options.every > 0) {
+        health_options.on_alarm = [](const string& line) { cerr << line << endl; };
+        health.open(health_options);
+        opt.health = &health;
+    }
 
-    return tableau;
-}
-
-/**
- * Main function where is implemented the parallel simplex
- * @param argc
- * @param argv
- * @return 
- */
-int main(int argc, char** argv) {
-    int numbThreads, constraintNumb, colNumb, ni = 0, chunk = 1;
-    int count = 0, conta = 0;
-
-    tableau = read_data(argv, constraintNumb, colNumb);
-
-    constraintNumb--;
-    colNumb--;
+    if (measure_energy && !energy.open(energy_root)) {
+        cerr << "No readable RAPL counters under " << energy_root << endl;
+        exit(EXIT_FAILURE);
+    }
 
-    from_string<int>(numbThreads, string(argv[2]), std::dec);
+    if (metrics_port > 0 || metrics_socket.size()) {
+        bool listening = metrics_socket.size() ? metrics.listen_unix(metrics_socket) : metrics.listen_port(metrics_port);
+        if (!listening) {
+            cerr << "Error opening metrics endpoint" << endl;
+            exit(EXIT_FAILURE);
+        }
+        opt.metrics = &metrics;
+    }
 
-    omp_set_num_threads(numbThreads);
-    //-----
-    log_file << "numbThreads " << numbThreads << endl;
+    if (flight_entries > 0) {
+        flight.open(flight_entries, flight_name);
+        flight.install();
+        opt.flight = &flight;
+    }
 
-    ni = 0;
+    if (trace_name.size() && trace_events > 0) {
+        trace.open(trace_events, trace_every);
+        opt.trace = &trace;
+    }
 
-    struct timespec timeTotalInit, timeTotalEnd;
+    if (verify) problem = lp.clone();
 
-    from_string<int>(chunk, string(argv[3]), std::dec);
-    log_file << "chunk " << chunk << endl;
+    if (progress_every > 0)
+        solver.set_progress([progress_every](const Simplex_Progress& p) {
+            if (p.iteration % progress_every == 0)
+                fprintf(stderr, "progress: iteration %d objective %f elapsed %.6f s\n", p.iteration, p.objective,
+                        p.elapsed);
+            return false;
+        });
 
-    struct Compare_Max max;
-    struct Compare_Min min;
+    running = &solver;
+    signal(SIGINT, on_interrupt);
 
     if (clock_gettime(CLOCK_REALTIME, &timeTotalInit)) {
         perror("clock gettime");
         exit(EXIT_FAILURE);
     }
 
-#pragma omp parallel default(none) shared(min,max,chunk,numbThreads,count,tableau,conta,colNumb,constraintNumb,ni)
-    {
-        double pivot, pivot2, pivot3;
-        int i, j;
-
-#pragma omp for schedule(guided,chunk) reduction(maximo:max) 
-        for (j = 0; j <= colNumb; j++)
-            if (tableau[constraintNumb][j] < 0.0 && max.val < (-tableau[constraintNumb][j])) {
-                max.val = -tableau[constraintNumb][j];
-                max.index = j;
-            }
+    if (measure_energy) energy_begin = energy.sample();
 
+    result = cache_dir.size() ? solver.solve(lp) : solver.solve_in_place(lp);
+    ni = result.iterations;
+    signal(SIGINT, SIG_DFL);
 
-#pragma omp single nowait
-        max.val = 0;
+    if (clock_gettime(CLOCK_REALTIME, &timeTotalEnd)) {
+        perror("clock gettime");
+        exit(EXIT_FAILURE);
+    }
 
-        do {
+    if (measure_energy) {
+        energy_end = energy.sample();
+        joules = energy.measure(energy_begin, energy_end);
+    }
 
-#pragma omp for reduction(+:count),reduction(minimo:min) schedule(guided,chunk) //guided e dynamic testar chunck size e reduction <
-            for (i = 0; i < constraintNumb; i++) {
-                if (tableau[i][max.index] > 0.0) {
-                    pivot = tableau[i][colNumb] / tableau[i][max.index];
-                    if (min.val > pivot) {
-                        min.val = pivot;
-                        min.index = i;
-                    }
-                } else
-                    count++;
-            }
+    // An empty basis: infeasible, or the first phase stopped before a
+    // feasible basis.
+    if (result.status == SIMPLEX_UNBOUNDED || result.basis.empty()) {
+        if (result.status != SIMPLEX_UNBOUNDED && result.status != SIMPLEX_INFEASIBLE)
+            fprintf(stderr, "%s: stopped before a feasible basis\n", status_name(result.status));
+        printf("Solução nao encontrada\n");
+        exit(1);
+    }
 
-#pragma omp single nowait //testar com mais singles
-            {
-                if (count == constraintNumb) {
-                    printf("Solução nao encontrada\n");
-                    exit(1);
-                } else
-                    count = 0;
-                conta = 0;
-            }
+    // A replay cut short by nothing but its own pivots met a zero element.
+    if (replay.size() && result.status == SIMPLEX_ITERATION_LIMIT && ni < (int) replayed.size() &&
+        (!opt.max_iterations || ni < opt.max_iterations)) {
+        cerr << "Pivot trace " << replay << " has a zero pivot element at iteration " << ni << endl;
+        exit(EXIT_FAILURE);
+    }
 
-            pivot = tableau[min.index][max.index];
-            pivot3 = -tableau[constraintNumb][max.index];
+    double processTime = elapsed_seconds(timeTotalInit, timeTotalEnd);
 
-#pragma omp barrier 
-#pragma omp for 
-            for (j = 0; j <= (colNumb); j++) {
-                tableau[min.index][j] = tableau[min.index][j] / pivot;
-            }
+    printf("%f %f ", processTime / ni, processTime);
+    printf("%d %f ", ni, result.objective);
+    if (measure_energy) printf("%f %f ", joules.total(), joules.total() / ni);
+    printf("\n");
+
+    if (measure_energy)
+        fprintf(stderr, "energy: package %.6f J, dram %.6f J%s, %.6f J per iteration, %.3f W\n",
+                joules.joules[ENERGY_PACKAGE], joules.joules[ENERGY_DRAM],
+                energy.has(ENERGY_DRAM) ? "" : " (not available)", joules.total() / ni,
+                joules.total() / processTime);
+
+    if (divergences)
+        cerr << divergences << " iterations diverge from the pivot trace" << endl;
+
+    if (result.status == SIMPLEX_CANCELLED)
+        cerr << "interrupted at iteration " << ni << ", the solution is not optimal" << endl;
+    if (result.status != SIMPLEX_OPTIMAL) {
+        if (result.bound < HUGE_VAL)
+            fprintf(stderr, "%s: bound %f, gap %f (%.3g%%)\n", status_name(result.status), result.bound, result.gap,
+                    100 * result.gap / std::max(fabs(result.bound), 1e-9));
+        else
+            fprintf(stderr, "%s: no bound of the optimal objective\n", status_name(result.status));
+    }
 
-#pragma omp for nowait 
-            for (i = 0; i < constraintNumb; i++) {
-                if (i != min.index) {
-                    pivot2 = -tableau[i][max.index];
-#pragma GCC ivdep
-                    for (j = 0; j <= colNumb; j++) {
-                        tableau[i][j] = (pivot2 * tableau[min.index][j]) + tableau[i][j];
-                    }
-                }
-            }
+    if (crash && !result.cached && !result.warm_start)
+        cerr << "crash: " << result.crash << " structural columns" << endl;
 
-#pragma omp for reduction(+:conta),reduction(maximo:max) schedule(guided,chunk)
-            for (j = 0; j <= colNumb; j++) {
-                tableau[constraintNumb][j] = (pivot3 * tableau[min.index][j]) + tableau[constraintNumb][j];
-                if (j < colNumb && tableau[constraintNumb][j] < 0.0) {
-                    conta++;
-                    if (max.val < (-tableau[constraintNumb][j])) {
-                        max.val = -tableau[constraintNumb][j];
-                        max.index = j;
-                    }
-                }
-            }
+    if (cache_dir.size())
+        cerr << (result.cached ? "cache: hit" : result.warm_start ? "cache: warm start" : "cache: miss") << endl;
 
-#pragma omp single 
-            {
-                ni++;
-                max.val = 0.0;
-                min.val = HUGE_VAL;
-            }
-        } while (conta);
+    if (record.size() && !write_pivot_trace(record, constraintNumb, colNumb, recorded)) {
+        cerr << "Error writing pivot trace " << record << endl;
+        exit(EXIT_FAILURE);
     }
 
+    if (sync_report)
+        cerr << sync_stats.report(processTime);
 
-    if (clock_gettime(CLOCK_REALTIME, &timeTotalEnd)) {
-        perror("clock gettime");
+    if (opt.health)
+        cerr << health.report();
+
+    string roofline_json;
+    if (roofline)
+        cerr << roofline_report(roof, profile, constraintNumb, colNumb, processTime, &roofline_json);
+
+    if (opt.trace && !trace.dump(trace_name)) {
+        cerr << "Error writing trace " << trace_name << endl;
         exit(EXIT_FAILURE);
     }
 
-    double ONE_SECOND_IN_NANOSECONDS = 1000000000;
-    struct timespec time = My_diff(timeTotalInit, timeTotalEnd);
-    double processTime = (time.tv_sec + (double) time.tv_nsec / ONE_SECOND_IN_NANOSECONDS);
+    if (telemetry.is_open()) {
+        Json_Line line = telemetry.run_line();
+        line.add("time", (long) time(0)).add("file", input).add("threads", numbThreads)
+            .add("chunk", chunk).add("kernel", kernel_name(opt.kernel))
+            .add("replay", replay).add("skip_search", opt.replay_skip_search)
+            .add("constraints", constraintNumb).add("variables", colNumb - constraintNumb)
+            .add("lines_read", input_stats.lines).add("min_row", input_stats.min_row)
+            .add("max_row", input_stats.max_row)
+            .add("read_time", elapsed_seconds(timeReadInit, timeTotalInit))
+            .add("solve_time", processTime).add("time_per_iteration", processTime / ni)
+            .add("iterations", ni).add("objective", result.objective)
+            .add("divergences", divergences).add("cached", result.cached)
+            .add("warm_start", result.warm_start).add("crash", result.crash).add("status", string(status_name(result.status)));
+        if (sync_report) line.add_raw("sync", sync_stats.json(processTime));
+        if (roofline) line.add_raw("roofline", roofline_json);
+        if (opt.health) line.add_raw("health", health.json());
+        if (measure_energy)
+            line.add("energy_package", joules.joules[ENERGY_PACKAGE]).add("energy_dram", joules.joules[ENERGY_DRAM])
+                .add("energy_per_iteration", joules.total() / ni).add("power", joules.total() / processTime);
+        telemetry.run(line);
+        telemetry.close();
+    }
 
-    printf("%f %f ", processTime / ni, processTime);
-    printf("%d %f \n", ni, tableau[constraintNumb][colNumb]);
+    int status = result.status == SIMPLEX_CANCELLED ? 3 : 0;
+    if (verify && result.status == SIMPLEX_OPTIMAL && !slack_basis_feasible(problem.tableau(), constraintNumb, colNumb)) {
+        cerr << "verify: skipped, the reference needs a feasible slack basis" << endl;
+    } else if (verify && result.status == SIMPLEX_OPTIMAL) {
+        vector<Pivot> reference_pivots;
+        reference_simplex(problem.tableau(), constraintNumb, colNumb, &reference_pivots);
+
+        Verify_Result check = compare_solves(lp.tableau(), problem.tableau(), constraintNumb, colNumb, recorded,
+                                             reference_pivots, Verify_Tolerances());
+        cerr << "verify: " << check.report() << endl;
+        if (!check.ok) status = 2;
+    }
 
-    delete_matrix(tableau, constraintNumb);
-    log_file.close();
+    return status;
 }
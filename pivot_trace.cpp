@@ -0,0 +1,112 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  pivot_trace.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Reading and writing of pivot-sequence trace files.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <fstream>
+#include <cstring>
+#include <stdint.h>
+
+#include "pivot_trace.h"
+
+static const char TRACE_MAGIC[4] = {'S', 'P', 'X', 'T'};
+static const uint64_t TRACE_VERSION = 1;
+
+/**
+ * Append an unsigned LEB128 varint to a buffer.
+ * @param buffer
+ * @param value
+ */
+static void put_varint(string& buffer, uint64_t value) {
+    do {
+        unsigned char byte = value & 0x7f;
+        value >>= 7;
+        buffer += (char) (value ? byte | 0x80 : byte);
+    } while (value);
+}
+
+/**
+ * Read an unsigned LEB128 varint from a stream.
+ * @param in
+ * @param value
+ * @return false at the end of the stream or on a malformed value
+ */
+static bool get_varint(istream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) return false;
+        value |= (uint64_t) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+/**
+ * Write a pivot sequence to a trace file.
+ * @param name
+ * @param constraintNumb
+ * @param colNumb
+ * @param pivots
+ * @return false if the file can not be written
+ */
+bool write_pivot_trace(const string& name, int constraintNumb, int colNumb, const vector<Pivot>& pivots) {
+    string buffer(TRACE_MAGIC, sizeof (TRACE_MAGIC));
+
+    put_varint(buffer, TRACE_VERSION);
+    put_varint(buffer, constraintNumb);
+    put_varint(buffer, colNumb);
+    put_varint(buffer, pivots.size());
+    for (size_t k = 0; k < pivots.size(); k++) {
+        put_varint(buffer, pivots[k].entering);
+        put_varint(buffer, pivots[k].leaving);
+    }
+
+    ofstream file(name.c_str(), ofstream::binary);
+    if (!file.is_open()) return false;
+    file.write(buffer.data(), buffer.size());
+    return file.good();
+}
+
+/**
+ * Read a pivot sequence from a trace file.
+ * @param name
+ * @param constraintNumb dimensions of the recorded problem
+ * @param colNumb
+ * @param pivots
+ * @return false if the file can not be read or is not a trace file
+ */
+bool read_pivot_trace(const string& name, int& constraintNumb, int& colNumb, vector<Pivot>& pivots) {
+    ifstream file(name.c_str(), ifstream::binary);
+    char magic[4];
+    uint64_t version, m, n, count;
+
+    if (!file.read(magic, sizeof (magic)) || memcmp(magic, TRACE_MAGIC, sizeof (magic)))
+        return false;
+    if (!get_varint(file, version) || version != TRACE_VERSION)
+        return false;
+    if (!get_varint(file, m) || !get_varint(file, n) || !get_varint(file, count))
+        return false;
+
+    constraintNumb = m;
+    colNumb = n;
+    pivots.clear();
+    for (uint64_t k = 0; k < count; k++) {
+        uint64_t entering, leaving;
+        if (!get_varint(file, entering) || !get_varint(file, leaving)) return false;
+        // The column colNumb holds the independent values, not a variable.
+        if (entering >= n || leaving >= m) return false;
+        Pivot p = {(int) entering, (int) leaving};
+        pivots.push_back(p);
+    }
+    return true;
+}
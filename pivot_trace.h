@@ -0,0 +1,38 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  pivot_trace.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Compact pivot-sequence trace files for recording a solve and replaying
+ *  exactly the same pivots later.
+ * @language: C++
+ *
+ * @section Description
+ *  The file starts with the magic "SPXT", a format version and the dimensions
+ *  of the problem, followed by the number of pivots and the (entering, leaving)
+ *  pairs. Every integer is written as an unsigned LEB128 varint, so a pivot
+ *  usually takes four to six bytes.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef PIVOT_TRACE_H
+#define PIVOT_TRACE_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct Pivot {
+    int entering;   // pivot column
+    int leaving;    // pivot row
+};
+
+bool write_pivot_trace(const string& name, int constraintNumb, int colNumb, const vector<Pivot>& pivots);
+bool read_pivot_trace(const string& name, int& constraintNumb, int& colNumb, vector<Pivot>& pivots);
+
+#endif
@@ -0,0 +1,61 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  probes.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief USDT static tracepoints of the solver, provider "simplex".
+ * @language: C++
+ *
+ * @section Description
+ *  When <sys/sdt.h> (systemtap-sdt-dev) is available the probes are compiled
+ *  as sdt notes: a single nop in the code and an ELF note, so they cost
+ *  nothing until a tracer attaches. Otherwise, or with -DSIMPLEX_NO_SDT, they
+ *  expand to nothing.
+ *
+ *  Probes and arguments:
+ *    load__start(path)
+ *    load__end(rows, columns, lines)
+ *    iteration__start(iteration)
+ *    iteration__end(iteration, entering, leaving, objective)
+ *    phase(tid, iteration, phase)            end of a phase (enum Phase)
+ *    sync__begin(tid, iteration, point)      arrival at a barrier (enum Sync_Point)
+ *    sync__end(tid, iteration, point)        departure from a barrier
+ *    pivot(iteration, entering, leaving, pivot)
+ *    unbounded(iteration, entering)
+ *
+ *  For example, a histogram of the iteration latency of a live solve:
+ *
+ *    bpftrace -e 'usdt:./exec_name:simplex:iteration__start { @s = nsecs; }
+ *                 usdt:./exec_name:simplex:iteration__end /@s/ { @us = hist((nsecs - @s) / 1000); }'
+ *
+ *  List the probes of a binary with: readelf -n exec_name | grep -A2 stapsdt
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#if !defined(SIMPLEX_NO_SDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define SIMPLEX_SDT 1
+#endif
+#endif
+
+#ifdef SIMPLEX_SDT
+#define SIMPLEX_PROBE1(name, a) DTRACE_PROBE1(simplex, name, a)
+#define SIMPLEX_PROBE2(name, a, b) DTRACE_PROBE2(simplex, name, a, b)
+#define SIMPLEX_PROBE3(name, a, b, c) DTRACE_PROBE3(simplex, name, a, b, c)
+#define SIMPLEX_PROBE4(name, a, b, c, d) DTRACE_PROBE4(simplex, name, a, b, c, d)
+#else
+#define SIMPLEX_PROBE1(name, a) do {} while (0)
+#define SIMPLEX_PROBE2(name, a, b) do {} while (0)
+#define SIMPLEX_PROBE3(name, a, b, c) do {} while (0)
+#define SIMPLEX_PROBE4(name, a, b, c, d) do {} while (0)
+#endif
+
+#endif
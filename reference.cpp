@@ -0,0 +1,137 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  reference.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Serial reference simplex and comparison of a solve against it.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <algorithm>
+
+#include "reference.h"
+
+/**
+ * Serial simplex on the tableau, in place.
+ * @param tableau
+ * @param constraintNumb index of the objective row
+ * @param colNumb index of the independent values column
+ * @param pivots when set, receives the (entering, leaving) pair of every iteration
+ * @param unbounded when set, receives whether the loop stopped on an unbounded column
+ * @return the number of iterations
+ */
+int reference_simplex(double **tableau, int constraintNumb, int colNumb, vector<Pivot> *pivots, bool *unbounded) {
+    int ni = 0;
+
+    if (unbounded) *unbounded = false;
+
+    for (;;) {
+        int col = -1, row = -1;
+        double best = 0, ratio = HUGE_VAL;
+
+        for (int j = 0; j < colNumb; j++)
+            if (-tableau[constraintNumb][j] > best) {
+                best = -tableau[constraintNumb][j];
+                col = j;
+            }
+        if (col < 0) break;
+
+        for (int i = 0; i < constraintNumb; i++)
+            if (tableau[i][col] > 0.0 && tableau[i][colNumb] / tableau[i][col] < ratio) {
+                ratio = tableau[i][colNumb] / tableau[i][col];
+                row = i;
+            }
+        if (row < 0) {
+            if (unbounded) *unbounded = true;
+            break;
+        }
+
+        double pivot = tableau[row][col];
+        for (int j = 0; j <= colNumb; j++)
+            tableau[row][j] /= pivot;
+
+        for (int i = 0; i <= constraintNumb; i++) {
+            if (i == row) continue;
+            double factor = tableau[i][col];
+            for (int j = 0; j <= colNumb; j++)
+                tableau[i][j] -= factor * tableau[row][j];
+        }
+
+        if (pivots) {
+            Pivot p = {col, row};
+            pivots->push_back(p);
+        }
+        ni++;
+    }
+    return ni;
+}
+
+/**
+ * Compare the final tableau and the pivots of a solve with the reference ones.
+ * @param tableau
+ * @param reference
+ * @param constraintNumb
+ * @param colNumb
+ * @param pivots
+ * @param reference_pivots
+ * @param tol
+ * @return
+ */
+Verify_Result compare_solves(double **tableau, double **reference, int constraintNumb, int colNumb,
+                             const vector<Pivot>& pivots, const vector<Pivot>& reference_pivots,
+                             const Verify_Tolerances& tol) {
+    Verify_Result r;
+
+    r.iterations = pivots.size();
+    r.reference_iterations = reference_pivots.size();
+    r.objective = tableau[constraintNumb][colNumb];
+    r.reference_objective = reference[constraintNumb][colNumb];
+    r.objective_error = fabs(r.objective - r.reference_objective) / (1 + fabs(r.reference_objective));
+
+    size_t common = min(pivots.size(), reference_pivots.size());
+    for (size_t k = 0; k < common && r.divergence < 0; k++)
+        if (pivots[k].entering != reference_pivots[k].entering || pivots[k].leaving != reference_pivots[k].leaving)
+            r.divergence = k;
+    if (r.divergence < 0 && pivots.size() != reference_pivots.size())
+        r.divergence = common;
+    if (r.divergence >= 0) {
+        if ((size_t) r.divergence < pivots.size()) r.pivot = pivots[r.divergence];
+        if ((size_t) r.divergence < reference_pivots.size()) r.reference_pivot = reference_pivots[r.divergence];
+    }
+
+    for (int i = 0; i <= constraintNumb; i++)
+        for (int j = 0; j <= colNumb; j++) {
+            double error = fabs(tableau[i][j] - reference[i][j]) / (1 + fabs(reference[i][j]));
+            if (error > r.tableau_error || r.worst_row < 0) {
+                r.tableau_error = error;
+                r.worst_row = i;
+                r.worst_col = j;
+            }
+        }
+
+    r.ok = r.divergence < 0 && r.objective_error <= tol.objective && r.tableau_error <= tol.tableau;
+    return r;
+}
+
+/**
+ * One line summary of a comparison.
+ * @return
+ */
+string Verify_Result::report() const {
+    char line[512];
+
+    int n = snprintf(line, sizeof (line), "%s objective %.12g reference %.12g (error %.3e), iterations %d reference %d, "
+                     "tableau error %.3e at (%d, %d)",
+                     ok ? "OK" : "FAIL", objective, reference_objective, objective_error, iterations,
+                     reference_iterations, tableau_error, worst_row, worst_col);
+    if (divergence >= 0)
+        snprintf(line + n, sizeof (line) - n, ", first divergence at iteration %d: (%d, %d) reference (%d, %d)",
+                 divergence, pivot.entering, pivot.leaving, reference_pivot.entering, reference_pivot.leaving);
+    return line;
+}
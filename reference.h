@@ -0,0 +1,63 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  reference.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Serial reference simplex and comparison of a solve against it.
+ * @language: C++
+ *
+ * @section Description
+ *  The reference is the textbook tableau loop, without OpenMP, fused loops or
+ *  row skipping: pricing on the most negative reduced cost, ratio test on the
+ *  positive coefficients of the entering column, and the row operations. Ties
+ *  go to the lowest index, as in the parallel reductions, so on the same input
+ *  both pick the same pivots unless rounding makes them differ.
+ *
+ *  The comparison reports the objective, the first iteration where the pivot
+ *  sequences differ and the largest entry-wise difference of the final
+ *  tableaux, all relative to 1 + |reference value|.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include <string>
+#include <vector>
+
+#include "simplex.h"
+
+using namespace std;
+
+struct Verify_Tolerances {
+    double objective = 1e-9;
+    double tableau = 1e-7;
+};
+
+struct Verify_Result {
+    bool ok = true;
+    int iterations = 0;
+    int reference_iterations = 0;
+    double objective = 0;
+    double reference_objective = 0;
+    double objective_error = 0;
+    int divergence = -1;                // first iteration with a different pivot, -1 if none
+    Pivot pivot = {-1, -1};             // pivots of the solve and of the reference there
+    Pivot reference_pivot = {-1, -1};
+    double tableau_error = 0;
+    int worst_row = -1;
+    int worst_col = -1;
+
+    string report() const;
+};
+
+int reference_simplex(double **tableau, int constraintNumb, int colNumb, vector<Pivot> *pivots, bool *unbounded = 0);
+Verify_Result compare_solves(double **tableau, double **reference, int constraintNumb, int colNumb,
+                             const vector<Pivot>& pivots, const vector<Pivot>& reference_pivots,
+                             const Verify_Tolerances& tol);
+
+#endif
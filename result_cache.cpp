@@ -0,0 +1,359 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  result_cache.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Content-addressed cache of solve results, in memory and on disk.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include "result_cache.h"
+
+static const char cache_magic[8] = {'S', 'P', 'X', 'C', 'A', 'C', 'H', '3'};
+
+/**
+ * Final mix of a 64-bit hash (splitmix64).
+ * @param h
+ * @return
+ */
+static inline uint64_t mix(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+static inline uint64_t combine(uint64_t h, uint64_t v) {
+    return mix(h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2)));
+}
+
+/**
+ * Hexadecimal name of the key.
+ * @return
+ */
+string Cache_Key::hex() const {
+    char name[40];
+    snprintf(name, sizeof (name), "%016llx%016llx", (unsigned long long) data[0], (unsigned long long) data[1]);
+    return name;
+}
+
+/**
+ * Key of a solve. Every row is hashed by one thread, the row hashes are then
+ * combined in order, so the key does not depend on the team.
+ * @param problem
+ * @param opt
+ * @param crash whether the solver starts from a crash basis (Solver::set_crash)
+ * @return
+ */
+Cache_Key Result_Cache::key(const Problem& problem, const Simplex_Options& opt, bool crash) {
+    int m = problem.constraints(), width = problem.width();
+    double **tableau = problem.tableau();
+    vector<uint64_t> first(m + 1), second(m + 1), pattern(m + 1);
+    Cache_Key key;
+
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i <= m; i++) {
+        uint64_t a = 0xcbf29ce484222325ULL, b = i, s = 0;
+        for (int j = 0; j <= width; j++) {
+            double v = tableau[i][j] == 0.0 ? 0.0 : tableau[i][j];
+            uint64_t w;
+            memcpy(&w, &v, sizeof (w));
+            a = (a ^ w) * 0x100000001b3ULL;
+            b = (b + w) * 0x9e3779b97f4a7c15ULL;
+            b ^= b >> 29;
+            if (w && i < m && j < width) s = (s ^ j) * 0x100000001b3ULL;
+        }
+        first[i] = mix(a);
+        second[i] = mix(b);
+        pattern[i] = mix(s);
+    }
+
+    uint64_t dims = ((uint64_t) m << 32) | (uint32_t) problem.variables(), tolerance;
+    memcpy(&tolerance, &opt.pivot_tolerance, sizeof (tolerance));
+    key.data[0] = combine(mix(dims), opt.max_iterations);
+    key.data[1] = combine(combine(mix(~dims), tolerance), crash ? 2 : 1);
+    key.shape = mix(dims);
+    key.constraints = m;
+    key.variables = problem.variables();
+    for (int i = 0; i <= m; i++) {
+        key.data[0] = combine(key.data[0], first[i]);
+        key.data[1] = combine(key.data[1], second[i]);
+        key.shape = combine(key.shape, pattern[i]);
+    }
+    return key;
+}
+
+/**
+ * Keep results on disk as well.
+ * @param dir existing directory
+ * @param bytes limit of the directory
+ * @return false when the directory can not be read
+ */
+bool Result_Cache::open_disk(const string& dir, size_t bytes) {
+    DIR *d = opendir(dir.c_str());
+    if (!d) return false;
+
+    lock_guard<mutex> guard(lock);
+    directory = dir;
+    disk_limit = bytes;
+    disk_used = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != 0) {
+        struct stat st;
+        string path = directory + "/" + e->d_name;
+        if (e->d_name[0] != '.' && !stat(path.c_str(), &st) && S_ISREG(st.st_mode)) disk_used += st.st_size;
+    }
+    closedir(d);
+    return true;
+}
+
+size_t Result_Cache::entry_bytes(const Result& result) {
+    return sizeof (Entry) + result.x.size() * sizeof (double) + result.duals.size() * sizeof (double)
+        + result.basis.size() * sizeof (int);
+}
+
+/**
+ * Stored result of a key, from memory or else from disk.
+ * @param key
+ * @param result receives the result, with cached set and no solve time
+ * @return false on a miss
+ */
+bool Result_Cache::lookup(const Cache_Key& key, Result& result) {
+    lock_guard<mutex> guard(lock);
+    unordered_map<string, list<Entry>::iterator>::iterator it = index.find(key.hex());
+
+    if (it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        result = it->second->result;
+        memory_hits++;
+    } else if (directory.size() && read_file(key, result)) {
+        remember(key, result);
+        disk_hits++;
+    } else {
+        misses++;
+        return false;
+    }
+    result.cached = true;
+    result.warm_start = false;
+    result.time = 0;
+    return true;
+}
+
+/**
+ * Basis of the last optimal solve of the key's shape.
+ * @param key
+ * @param constraints
+ * @param basis receives one variable per row
+ * @return false when there is none
+ */
+bool Result_Cache::basis(const Cache_Key& key, int constraints, vector<int>& basis) {
+    lock_guard<mutex> guard(lock);
+    unordered_map<uint64_t, vector<int> >::iterator it = shapes.find(key.shape);
+
+    if (it != shapes.end()) {
+        basis = it->second;
+    } else {
+        if (directory.empty()) return false;
+        char name[32];
+        snprintf(name, sizeof (name), "/%016llx.basis", (unsigned long long) key.shape);
+        FILE *f = fopen((directory + name).c_str(), "rb");
+        if (!f) return false;
+        basis.resize(constraints);
+        bool ok = fread(basis.data(), sizeof (int), constraints, f) == (size_t) constraints && fgetc(f) == EOF;
+        fclose(f);
+        if (!ok) return false;
+    }
+    return (int) basis.size() == constraints;
+}
+
+/**
+ * Count a warm start attempt.
+ * @param feasible false when the cached basis could not be used
+ */
+void Result_Cache::warm_started(bool feasible) {
+    lock_guard<mutex> guard(lock);
+    if (feasible) warm_starts++;
+    else warm_rejected++;
+}
+
+/**
+ * Store the result of a solve, and its basis for the shape when optimal.
+ * @param key
+ * @param result
+ */
+void Result_Cache::store(const Cache_Key& key, const Result& result) {
+    lock_guard<mutex> guard(lock);
+
+    remember(key, result);
+    if (result.status == SIMPLEX_OPTIMAL) {
+        if (shapes.size() >= 4096) shapes.erase(shapes.begin());
+        shapes[key.shape] = result.basis;
+    }
+    if (directory.size()) {
+        write_file(key, result);
+        trim_disk();
+    }
+}
+
+/**
+ * Put a result at the front of the memory tier and evict the least recently
+ * used ones past the limit. Called with the lock held.
+ * @param key
+ * @param result
+ */
+void Result_Cache::remember(const Cache_Key& key, const Result& result) {
+    string name = key.hex();
+    unordered_map<string, list<Entry>::iterator>::iterator it = index.find(name);
+
+    if (it != index.end()) {
+        memory_used -= it->second->bytes;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    Entry e = {key, result, entry_bytes(result)};
+    e.result.cached = e.result.warm_start = false;
+    if (e.bytes > memory_limit) return;
+    lru.push_front(e);
+    index[name] = lru.begin();
+    memory_used += e.bytes;
+
+    while (memory_used > memory_limit) {
+        memory_used -= lru.back().bytes;
+        index.erase(lru.back().key.hex());
+        lru.pop_back();
+    }
+}
+
+/**
+ * Read the file of a key. Called with the lock held.
+ * @param key
+ * @param result left untouched unless the file is read
+ * @return false when missing, corrupt, truncated or of other dimensions
+ */
+bool Result_Cache::read_file(const Cache_Key& key, Result& result) {
+    string path = directory + "/" + key.hex() + ".result";
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    char magic[8];
+    int header[4];
+    double values[3];
+    Result r;
+    bool ok = fread(magic, 1, 8, f) == 8 && !memcmp(magic, cache_magic, 8) && fread(header, sizeof (int), 4, f) == 4
+        && fread(values, sizeof (double), 3, f) == 3 && header[0] == key.constraints
+        && header[1] == key.variables && header[2] >= 0 && header[2] < SIMPLEX_STATUS_COUNT;
+    if (ok) {
+        r.status = (Simplex_Status) header[2];
+        r.iterations = header[3];
+        r.objective = values[0];
+        r.time = values[1];
+        r.bound = values[2];
+        r.gap = values[2] - values[0];
+        r.x.resize(header[1]);
+        r.duals.resize(header[0]);
+        r.basis.resize(header[0]);
+        ok = fread(r.x.data(), sizeof (double), header[1], f) == (size_t) header[1]
+            && fread(r.duals.data(), sizeof (double), header[0], f) == (size_t) header[0]
+            && fread(r.basis.data(), sizeof (int), header[0], f) == (size_t) header[0] && fgetc(f) == EOF;
+    }
+    fclose(f);
+    if (!ok) return false;
+    result = r;
+    utime(path.c_str(), 0);
+    return true;
+}
+
+/**
+ * Write the file of a key, and of its shape's basis. Called with the lock
+ * held.
+ * @param key
+ * @param result
+ */
+void Result_Cache::write_file(const Cache_Key& key, const Result& result) {
+    string path = directory + "/" + key.hex() + ".result";
+    string temporary = path + "." + to_string(getpid()) + ".tmp";
+    FILE *f = fopen(temporary.c_str(), "wb");
+    if (!f) return;
+
+    int header[4] = {(int) result.duals.size(), (int) result.x.size(), result.status, result.iterations};
+    double values[3] = {result.objective, result.time, result.bound};
+    bool ok = fwrite(cache_magic, 1, 8, f) == 8 && fwrite(header, sizeof (int), 4, f) == 4
+        && fwrite(values, sizeof (double), 3, f) == 3
+        && fwrite(result.x.data(), sizeof (double), result.x.size(), f) == result.x.size()
+        && fwrite(result.duals.data(), sizeof (double), result.duals.size(), f) == result.duals.size()
+        && fwrite(result.basis.data(), sizeof (int), result.basis.size(), f) == result.basis.size();
+    ok = !fclose(f) && ok;
+    if (!ok || rename(temporary.c_str(), path.c_str())) {
+        unlink(temporary.c_str());
+        return;
+    }
+    disk_used += 8 + sizeof (header) + sizeof (values) + entry_bytes(result) - sizeof (Entry);
+
+    if (result.status != SIMPLEX_OPTIMAL) return;
+    char name[32];
+    snprintf(name, sizeof (name), "/%016llx.basis", (unsigned long long) key.shape);
+    path = directory + name;
+    temporary = path + "." + to_string(getpid()) + ".tmp";
+    if (!(f = fopen(temporary.c_str(), "wb"))) return;
+    ok = fwrite(result.basis.data(), sizeof (int), result.basis.size(), f) == result.basis.size();
+    ok = !fclose(f) && ok;
+    if (!ok || rename(temporary.c_str(), path.c_str())) unlink(temporary.c_str());
+    else disk_used += result.basis.size() * sizeof (int);
+}
+
+/**
+ * Remove the least recently used files until the directory is back under 90%
+ * of its limit. Called with the lock held.
+ */
+void Result_Cache::trim_disk() {
+    if (disk_used <= disk_limit) return;
+
+    vector<pair<time_t, string> > files;
+    DIR *d = opendir(directory.c_str());
+    if (!d) return;
+    struct dirent *e;
+    disk_used = 0;
+    while ((e = readdir(d)) != 0) {
+        struct stat st;
+        string path = directory + "/" + e->d_name;
+        if (e->d_name[0] == '.' || stat(path.c_str(), &st) || !S_ISREG(st.st_mode)) continue;
+        files.push_back(make_pair(st.st_mtime, path));
+        disk_used += st.st_size;
+    }
+    closedir(d);
+
+    sort(files.begin(), files.end());
+    for (size_t k = 0; k < files.size() && disk_used > disk_limit / 10 * 9; k++) {
+        struct stat st;
+        if (!stat(files[k].second.c_str(), &st) && !unlink(files[k].second.c_str())) disk_used -= st.st_size;
+    }
+}
+
+/**
+ * One line summary of the cache.
+ * @return
+ */
+string Result_Cache::report() const {
+    lock_guard<mutex> guard(lock);
+    char line[256];
+
+    snprintf(line, sizeof (line), "result cache: %ld memory hits, %ld disk hits, %ld misses, %ld warm starts "
+             "(%ld rejected), %zu results in %.1f MiB", memory_hits, disk_hits, misses, warm_starts, warm_rejected,
+             lru.size(), memory_used / 1048576.0);
+    return line;
+}
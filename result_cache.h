@@ -0,0 +1,100 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  result_cache.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Content-addressed cache of solve results, in memory and on disk.
+ * @language: C++
+ *
+ * @section Description
+ *  The key of a solve is a 128-bit hash of the problem data (the dimensions
+ *  and every tableau value, with -0 read as 0) and of the options that change
+ *  the result (iteration limit, pivot tolerance, and the crash basis of the
+ *  solver, which changes the iterations), computed row by row by the OpenMP
+ *  team. A hit returns the stored status, objective, solution, duals and
+ *  basis without solving.
+ *
+ *  The memory tier is an LRU list bounded in bytes. The disk tier, when open,
+ *  keeps one file per result in a directory (written to a temporary name and
+ *  renamed, so concurrent processes can share it) and removes the least
+ *  recently used files when the directory grows past its limit.
+ *
+ *  Problems with the same dimensions and the same nonzero pattern share a
+ *  shape hash; the basis of the last optimal solve of a shape is kept and can
+ *  warm start the next problem of that shape (Solver::set_cache).
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "solver.h"
+
+using namespace std;
+
+struct Cache_Key {
+    uint64_t data[2] = {0, 0};     // problem values and options
+    uint64_t shape = 0;             // dimensions and nonzero pattern
+    int constraints = 0;
+    int variables = 0;
+
+    string hex() const;
+};
+
+class Result_Cache {
+public:
+    explicit Result_Cache(size_t memory_bytes = (size_t) 256 << 20) : memory_limit(memory_bytes) {}
+
+    bool open_disk(const string& directory, size_t bytes);
+
+    static Cache_Key key(const Problem& problem, const Simplex_Options& opt, bool crash = false);
+    bool lookup(const Cache_Key& key, Result& result);
+    bool basis(const Cache_Key& key, int constraints, vector<int>& basis);
+    void store(const Cache_Key& key, const Result& result);
+
+    void warm_started(bool feasible);
+    string report() const;
+
+private:
+    struct Entry {
+        Cache_Key key;
+        Result result;
+        size_t bytes;
+    };
+
+    static size_t entry_bytes(const Result& result);
+    void remember(const Cache_Key& key, const Result& result);
+    bool read_file(const Cache_Key& key, Result& result);
+    void write_file(const Cache_Key& key, const Result& result);
+    void trim_disk();
+
+    mutable mutex lock;
+    list<Entry> lru;
+    unordered_map<string, list<Entry>::iterator> index;
+    unordered_map<uint64_t, vector<int> > shapes;
+    size_t memory_used = 0;
+    size_t memory_limit;
+
+    string directory;
+    size_t disk_used = 0;
+    size_t disk_limit = 0;
+
+    long memory_hits = 0;
+    long disk_hits = 0;
+    long misses = 0;
+    long warm_starts = 0;
+    long warm_rejected = 0;
+};
+
+#endif
@@ -0,0 +1,199 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  roofline.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Host probes for a roofline estimate and roofline report of a solve.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <omp.h>
+#include <cstdio>
+#include <algorithm>
+
+#include "roofline.h"
+#include "telemetry.h"
+
+using namespace std;
+
+/**
+ * STREAM triad a = b + s * c, best of the trials. The arrays are initialized
+ * in parallel so the pages are placed near the threads that use them.
+ * @param n number of elements of each array
+ * @param trials
+ * @return bytes per second
+ */
+double stream_bandwidth(size_t n, int trials) {
+    double *a = new double[n], *b = new double[n], *c = new double[n];
+    double s = 3.0, best = 0;
+    long i, len = n;
+
+#pragma omp parallel for schedule(static)
+    for (i = 0; i < len; i++) {
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+
+    for (int t = 0; t < trials; t++) {
+        double start = omp_get_wtime();
+
+#pragma omp parallel for schedule(static)
+        for (i = 0; i < len; i++)
+            a[i] = b[i] + s * c[i];
+
+        double time = omp_get_wtime() - start;
+        best = max(best, 3.0 * sizeof (double) * n / time);
+    }
+
+    delete [] a;
+    delete [] b;
+    delete [] c;
+    return best;
+}
+
+/**
+ * Independent multiply-add chains on every thread, wide enough to fill the
+ * vector units and hide the latency of the FMA pipeline. Best of the trials.
+ * @param iterations
+ * @param trials
+ * @return floating point operations per second
+ */
+double peak_flops(long iterations, int trials) {
+    const int LANES = 32;
+    double best = 0, sink = 0;
+
+    for (int t = 0; t < trials; t++) {
+        int threads = 1;
+        double start = omp_get_wtime();
+
+#pragma omp parallel reduction(+:sink)
+        {
+            double acc[LANES], x = 0.999999, y = 1e-7;
+
+#pragma omp single
+            threads = omp_get_num_threads();
+
+            for (int k = 0; k < LANES; k++) acc[k] = k;
+
+            for (long i = 0; i < iterations; i++)
+#pragma omp simd
+                for (int k = 0; k < LANES; k++)
+                    acc[k] = acc[k] * x + y;
+
+            for (int k = 0; k < LANES; k++) sink += acc[k];
+        }
+
+        double time = omp_get_wtime() - start;
+        best = max(best, 2.0 * LANES * iterations * threads / time);
+    }
+
+    // Keeps the chains alive.
+    if (sink == -1.0) best = 0;
+    return best;
+}
+
+/**
+ * Bandwidth and peak FLOP rate of the host.
+ * @param n number of elements of each STREAM array
+ * @param iterations of the FLOP probe
+ * @return
+ */
+Roofline measure_roofline(size_t n, long iterations) {
+    Roofline roof;
+    roof.bandwidth = stream_bandwidth(n, 5);
+    roof.flops = peak_flops(iterations, 3);
+    return roof;
+}
+
+/**
+ * Attainable FLOP rate for a given arithmetic intensity.
+ * @param roof
+ * @param intensity FLOPs per byte
+ * @return
+ */
+double attainable_flops(const Roofline& roof, double intensity) {
+    return min(roof.flops, intensity * roof.bandwidth);
+}
+
+/**
+ * Roofline report of a solve: bytes, FLOPs, achieved GB/s and GFLOP/s and
+ * percentage of the attainable FLOP rate for each segment of the pivot loop.
+ * @param roof host probes
+ * @param profile of the solve
+ * @param constraintNumb
+ * @param colNumb
+ * @param wall solve time in seconds
+ * @param json when set, receives the report as a JSON object
+ * @return the human readable report
+ */
+string roofline_report(const Roofline& roof, const Solve_Profile& profile, int constraintNumb, int colNumb,
+                       double wall, string *json) {
+    const double CACHE_LINE = 64, WORD = sizeof (double);
+    double W = colNumb + 1, M = constraintNumb, it = profile.iterations;
+
+    struct Segment {
+        const char *name;
+        double bytes;
+        double flops;
+        double time;
+    } seg[5] = {
+        {"pricing", profile.searched ? W * WORD : 0, profile.searched ? W : 0,
+            profile.phase[PHASE_PRICING] + profile.wait[SYNC_PRICING]},
+        {"ratio", profile.searched ? it * M * 2 * CACHE_LINE : 0, (double) profile.ratio_rows,
+            profile.phase[PHASE_RATIO] + profile.wait[SYNC_RATIO]},
+        {"normalize", it * W * 2 * WORD, it * W,
+            profile.phase[PHASE_NORMALIZE] + profile.wait[SYNC_NORMALIZE]},
+        // Row update plus objective update with the fused pricing.
+        {"update", profile.rows_updated * W * 2 * WORD + it * W * 4 * WORD, profile.rows_updated * W * 2 + it * W * 3,
+            profile.phase[PHASE_ELIMINATE] + profile.phase[PHASE_OBJECTIVE] + profile.wait[SYNC_OBJECTIVE]},
+        {"total", 0, 0, wall}
+    };
+    for (int k = 0; k < 4; k++) {
+        seg[4].bytes += seg[k].bytes;
+        seg[4].flops += seg[k].flops;
+    }
+
+    char line[256];
+    string out;
+    snprintf(line, sizeof (line), "roofline: %.2f GB/s, %.2f GFLOP/s with %d threads\n",
+             roof.bandwidth / 1e9, roof.flops / 1e9, profile.threads);
+    out += line;
+    snprintf(line, sizeof (line), "%-10s %12s %12s %11s %9s %9s %9s %9s %7s\n",
+             "segment", "GB", "GFLOP", "time (s)", "GB/s", "GFLOP/s", "FLOP/B", "roof", "%roof");
+    out += line;
+
+    if (json) {
+        Json_Line host;
+        host.add("bandwidth", roof.bandwidth).add("flops", roof.flops).add("threads", profile.threads);
+        *json = "{\"host\": " + host.str() + ", \"segments\": [";
+    }
+
+    for (int k = 0; k < 5; k++) {
+        double time = seg[k].time > 0 ? seg[k].time : 1e-12;
+        double intensity = seg[k].bytes > 0 ? seg[k].flops / seg[k].bytes : 0;
+        double roof_flops = attainable_flops(roof, intensity);
+        double percent = roof_flops > 0 ? 100.0 * seg[k].flops / time / roof_flops : 0;
+
+        snprintf(line, sizeof (line), "%-10s %12.4f %12.4f %11.6f %9.3f %9.3f %9.4f %9.3f %6.1f%%\n",
+                 seg[k].name, seg[k].bytes / 1e9, seg[k].flops / 1e9, seg[k].time,
+                 seg[k].bytes / time / 1e9, seg[k].flops / time / 1e9, intensity, roof_flops / 1e9, percent);
+        out += line;
+
+        if (json) {
+            Json_Line s;
+            s.add("segment", seg[k].name).add("bytes", seg[k].bytes).add("flops", seg[k].flops)
+                .add("time", seg[k].time).add("gb_s", seg[k].bytes / time / 1e9)
+                .add("gflop_s", seg[k].flops / time / 1e9).add("intensity", intensity)
+                .add("roof_gflop_s", roof_flops / 1e9).add("roof_percent", percent);
+            *json += (k ? ", " : "") + s.str();
+        }
+    }
+    if (json) *json += "]}";
+    return out;
+}
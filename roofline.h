@@ -0,0 +1,45 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  roofline.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Host probes for a roofline estimate: STREAM-style triad bandwidth and
+ *  peak double precision FLOP rate with the current number of OpenMP threads,
+ *  and the roofline report of a solve.
+ * @language: C++
+ *
+ * @section Description
+ *  The report derives the bytes moved and the FLOPs of each segment of the
+ *  pivot loop from the tableau dimensions, the iterations and the skip counts
+ *  of the solve (rows left out of the ratio test and of the row update). The
+ *  time of a segment is the work of thread 0 in it plus its wait at the barrier
+ *  that closes it, i.e. the wall time of the segment. The ratio test reads two
+ *  strided elements per row, so its traffic is counted as two cache lines.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include <cstddef>
+#include <string>
+
+#include "simplex.h"
+
+struct Roofline {
+    double bandwidth = 0;   // bytes per second
+    double flops = 0;       // floating point operations per second
+};
+
+double stream_bandwidth(size_t n, int trials);
+double peak_flops(long iterations, int trials);
+Roofline measure_roofline(size_t n = 1 << 23, long iterations = 1 << 22);
+double attainable_flops(const Roofline& roof, double intensity);
+string roofline_report(const Roofline& roof, const Solve_Profile& profile, int constraintNumb, int colNumb,
+                       double wall, string *json = 0);
+
+#endif
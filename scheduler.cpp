@@ -0,0 +1,309 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  scheduler.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief In-process scheduler of concurrent solves sharing the cores.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <thread>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "scheduler.h"
+
+/**
+ * Pin the calling thread to a CPU.
+ * @param cpus CPUs of the process affinity mask
+ * @param core index of the core in cpus
+ */
+static void pin_thread(const vector<int>& cpus, int core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[core % cpus.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof (set), &set);
+}
+
+Scheduler::Scheduler(int cores) : total(cores > 0 ? cores : omp_get_num_procs()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof (set), &set) == 0)
+        for (int c = 0; c < CPU_SETSIZE; c++)
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+    if (cpus.empty())
+        for (int c = 0; c < sysconf(_SC_NPROCESSORS_ONLN); c++) cpus.push_back(c);
+}
+
+Scheduler::~Scheduler() {
+    wait();
+}
+
+/**
+ * Queue a solve. It starts as soon as a core is free.
+ * @param problem
+ * @param options
+ * @return the result, once the solve ends
+ */
+future<Result> Scheduler::submit(Problem&& problem, const Job_Options& options) {
+    Job *job = new Job;
+    job->problem = move(problem);
+    job->options = options;
+    future<Result> result = job->done.get_future();
+
+    queue(job);
+    return result;
+}
+
+/**
+ * Queue a solve that publishes its progress.
+ * @param problem
+ * @param options
+ * @return the task of the solve
+ */
+shared_ptr<Solve_Task> Scheduler::start(Problem&& problem, const Job_Options& options) {
+    Job *job = new Job;
+    job->problem = move(problem);
+    job->options = options;
+    job->task = make_shared<Solve_Task>();
+    job->task->result = job->done.get_future().share();
+
+    shared_ptr<Solve_Task> task = job->task;
+    queue(job);
+    return task;
+}
+
+/**
+ * Put a job in the waiting list, after those of the same priority.
+ * @param job
+ */
+void Scheduler::queue(Job *job) {
+    lock_guard<mutex> guard(lock);
+    job->arrival = arrivals++;
+    list<Job *>::iterator it = waiting.begin();
+    while (it != waiting.end() && (*it)->options.priority >= job->options.priority) ++it;
+    waiting.insert(it, job);
+    admit();
+}
+
+/**
+ * Wait for every submitted job to end.
+ */
+void Scheduler::wait() {
+    unique_lock<mutex> guard(lock);
+    idle.wait(guard, [this] { return running.empty() && waiting.empty(); });
+}
+
+/**
+ * Start the waiting jobs while there are free cores and share the cores
+ * again. Called with the lock held.
+ */
+void Scheduler::admit() {
+    vector<Job *> started;
+
+    while (!waiting.empty() && (int) running.size() < total) {
+        running.push_back(waiting.front());
+        started.push_back(waiting.front());
+        waiting.pop_front();
+    }
+    share();
+    for (size_t k = 0; k < started.size(); k++)
+        thread(&Scheduler::run, this, started[k]).detach();
+}
+
+/**
+ * Weighted fair share of the cores among the running jobs: one core each,
+ * then every spare core to the job with the fewest cores per unit of
+ * priority that is below its cap. Called with the lock held.
+ */
+void Scheduler::share() {
+    int n = running.size(), spare = total - n, first = 0;
+    vector<Job *> jobs(running.begin(), running.end());
+    vector<int> size(n, 1);
+
+    for (; spare > 0; spare--) {
+        int best = -1;
+        for (int k = 0; k < n; k++) {
+            const Job_Options& o = jobs[k]->options;
+            if (o.max_threads > 0 && size[k] >= o.max_threads) continue;
+            if (best < 0 || (double) size[k] / std::max(1, o.priority) <
+                (double) size[best] / std::max(1, jobs[best]->options.priority))
+                best = k;
+        }
+        if (best < 0) break;
+        size[best]++;
+    }
+
+    for (int k = 0; k < n; k++) {
+        bool moved = jobs[k]->first_cpu.load(memory_order_relaxed) != first;
+        jobs[k]->first_cpu.store(first, memory_order_relaxed);
+        jobs[k]->team.store(size[k], memory_order_relaxed);
+        if (moved) jobs[k]->placement.fetch_add(1);
+        first += size[k];
+    }
+}
+
+/**
+ * Thread of a job: solve with the team size given by the scheduler.
+ * @param job
+ */
+void Scheduler::run(Job *job) {
+    Solver solver;
+    Simplex_Options& o = solver.options();
+
+    solver.set_chunk(job->options.chunk);
+    solver.set_kernel(job->options.kernel);
+    solver.set_max_iterations(job->options.max_iterations);
+    solver.set_time_limit(job->options.time_limit);
+    solver.set_target(job->options.target);
+    o.team_size = &job->team;
+    if (pinning) {
+        const vector<int> *cpus = &this->cpus;
+        o.placement = &job->placement;
+        o.on_segment = [job, cpus](int tid) { pin_thread(*cpus, job->first_cpu.load() + tid); };
+    }
+    if (job->task) {
+        Solve_Task *task = job->task.get();
+        o.on_progress = [task](const Simplex_Progress& p) {
+            task->publish(p, false);
+            return task->cancelled.load(memory_order_relaxed);
+        };
+    }
+
+    Result r = solver.solve_in_place(job->problem);
+    Simplex_Progress last;
+    last.iteration = r.iterations;
+    last.objective = r.objective;
+    last.elapsed = r.time;
+    job->done.set_value(r);
+    if (job->task) job->task->publish(last, true);
+
+    {
+        lock_guard<mutex> guard(lock);
+        running.remove(job);
+        finished++;
+        admit();
+        if (running.empty() && waiting.empty()) idle.notify_all();
+    }
+    delete job;
+}
+
+/**
+ * Latest snapshot, read without the lock: retried while the job's thread is
+ * writing it.
+ * @return
+ */
+Simplex_Progress Solve_Task::progress() const {
+    Simplex_Progress p;
+    unsigned before, after;
+
+    do {
+        before = sequence.load();
+        p.iteration = iteration.load(memory_order_relaxed);
+        p.objective = objective.load(memory_order_relaxed);
+        p.elapsed = elapsed.load(memory_order_relaxed);
+        p.iteration_time = iteration_time.load(memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        after = sequence.load(memory_order_relaxed);
+    } while (before != after || before % 2);
+    return p;
+}
+
+/**
+ * Whether the result is ready.
+ * @return
+ */
+bool Solve_Task::done() const {
+    return finished.load();
+}
+
+/**
+ * Block until a snapshot past an iteration, or the end.
+ * @param after
+ * @return the latest snapshot
+ */
+Simplex_Progress Solve_Task::wait_progress(int after) const {
+    unique_lock<mutex> guard(lock);
+    pending++;
+    changed.wait(guard, [this, after] { return finished.load() || progress().iteration > after; });
+    pending--;
+    return progress();
+}
+
+/**
+ * Register a wake-up for a snapshot past an iteration, or the end. It is
+ * called once, on the job's thread, without the lock.
+ * @param after
+ * @param wake
+ * @return false, without registering, when such a snapshot is already there
+ */
+bool Solve_Task::notify(int after, const function<void()>& wake) {
+    lock_guard<mutex> guard(lock);
+    // Counted before the snapshot is checked, so publish either sees the
+    // waiter or has already stored a snapshot that satisfies it.
+    pending++;
+    if (finished.load() || progress().iteration > after) {
+        pending--;
+        return false;
+    }
+    Waiter w = {after, wake};
+    waiters.push_back(w);
+    return true;
+}
+
+/**
+ * Publish a snapshot and wake the waiters it satisfies. Called by the job's
+ * thread only; the lock is taken only when somebody waits, or at the end.
+ * @param snapshot
+ * @param end true for the last one, after the result is set
+ */
+void Solve_Task::publish(const Simplex_Progress& snapshot, bool end) {
+    unsigned s = sequence.load(memory_order_relaxed);
+    sequence.store(s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    iteration.store(snapshot.iteration, memory_order_relaxed);
+    objective.store(snapshot.objective, memory_order_relaxed);
+    elapsed.store(snapshot.elapsed, memory_order_relaxed);
+    iteration_time.store(snapshot.iteration_time, memory_order_relaxed);
+    sequence.store(s + 2);
+    if (end) finished.store(true);
+    if (!end && pending.load() == 0) return;
+
+    vector<Waiter> due;
+    {
+        lock_guard<mutex> guard(lock);
+        for (size_t k = 0; k < waiters.size(); )
+            if (end || snapshot.iteration > waiters[k].after) {
+                due.push_back(waiters[k]);
+                waiters[k] = waiters.back();
+                waiters.pop_back();
+            } else {
+                k++;
+            }
+        pending -= due.size();
+    }
+    changed.notify_all();
+    for (size_t k = 0; k < due.size(); k++) due[k].wake();
+}
+
+/**
+ * One line summary: the team of every running job and the queue.
+ * @return
+ */
+string Scheduler::report() const {
+    lock_guard<mutex> guard(lock);
+    string out = "scheduler: " + to_string(total) + " cores, running [";
+
+    for (list<Job *>::const_iterator it = running.begin(); it != running.end(); ++it)
+        out += (it == running.begin() ? "" : " ") + to_string((*it)->team.load()) + "@"
+            + to_string((*it)->first_cpu.load());
+    out += "], " + to_string(waiting.size()) + " waiting, " + to_string(finished) + " finished";
+    return out;
+}
@@ -0,0 +1,197 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  scheduler.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief In-process scheduler of concurrent solves sharing the cores.
+ * @language: C++
+ *
+ * @section Description
+ *  Every job runs on its own thread with an OpenMP team whose size is set by
+ *  the scheduler through Simplex_Options::team_size, so the teams of all the
+ *  running jobs add up to the number of cores and never more. Each time a job
+ *  arrives or finishes the cores are shared again: one core per running job,
+ *  then each spare core in turn to the job with the fewest cores per unit of
+ *  priority among those below their max_threads (ties to the earliest
+ *  running). The jobs see their new size at the next iteration boundary.
+ *  Each job gets a contiguous set of cores, to which its threads are pinned
+ *  when pinning is on: core k is the k-th CPU of the process affinity mask,
+ *  and a job whose cores move is pinned again at its next iteration boundary,
+ *  even when its size stays the same.
+ *
+ *  At most one job per core runs at a time; the others wait in order of
+ *  priority, then of arrival.
+ *
+ *  start queues a job like submit and returns a Solve_Task, which follows it
+ *  without blocking any thread of the caller: the job publishes a snapshot of
+ *  its progress at every iteration boundary, and notify registers a wake-up
+ *  for a snapshot newer than a given iteration, called on the job's thread
+ *  (e.g. to post to an event loop). The snapshot is written through a seqlock;
+ *  the job only takes the lock of the task, and wakes anyone, while a wake-up
+ *  is registered or a wait_progress call is blocked. With C++20 coroutines,
+ *  next and finish are awaitables built on notify that resume the coroutine
+ *  through the caller's executor, so one event loop can drive many solves:
+ *
+ *    shared_ptr<Solve_Task> task = scheduler.start(move(p));
+ *    for (int seen = 0; !task->done(); ) {
+ *        Simplex_Progress s = co_await task->next(seen, post);
+ *        seen = s.iteration;
+ *    }
+ *    Result r = co_await task->finish(post);
+ *
+ *  Example:
+ *
+ *    Scheduler scheduler;
+ *    Job_Options urgent;
+ *    urgent.priority = 4;
+ *    future<Result> a = scheduler.submit(move(p), urgent);
+ *    future<Result> b = scheduler.submit(move(q));
+ *    Result r = a.get();
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#endif
+
+#include "solver.h"
+
+using namespace std;
+
+struct Job_Options {
+    int priority = 1;           // share of the cores, relative to the other jobs
+    int max_threads = 0;        // 0 for no cap
+    int chunk = 1;
+    int kernel = KERNEL_BASELINE;
+    int max_iterations = 0;
+    double time_limit = 0;      // seconds, 0 for no limit
+    double target = HUGE_VAL;   // stop once the objective reaches it
+};
+
+/**
+ * Progress and result of a started job, shared by its thread and its callers.
+ */
+class Solve_Task {
+public:
+    typedef function<void(function<void()>)> Executor;
+
+    Simplex_Progress progress() const;
+    bool done() const;
+    Simplex_Progress wait_progress(int after) const;
+    bool notify(int after, const function<void()>& wake);
+    void cancel() { cancelled = true; }
+    Result get() const { return result.get(); }
+
+#ifdef __cpp_impl_coroutine
+    // Awaits a snapshot past iteration 'after', or the end of the job.
+    struct Progress_Awaiter {
+        Solve_Task *task;
+        int after;
+        Executor post;
+
+        bool await_ready() const { return task->done() || task->progress().iteration > after; }
+        bool await_suspend(coroutine_handle<> h) {
+            Executor p = post;
+            return task->notify(after, [p, h] { p([h] { h.resume(); }); });
+        }
+        Simplex_Progress await_resume() const { return task->progress(); }
+    };
+
+    // Awaits the result.
+    struct Result_Awaiter {
+        Progress_Awaiter end;
+
+        bool await_ready() const { return end.task->done(); }
+        bool await_suspend(coroutine_handle<> h) { return end.await_suspend(h); }
+        Result await_resume() const { return end.task->get(); }
+    };
+
+    Progress_Awaiter next(int after, const Executor& post) { return Progress_Awaiter{this, after, post}; }
+    Result_Awaiter finish(const Executor& post) { return Result_Awaiter{Progress_Awaiter{this, INT_MAX, post}}; }
+#endif
+
+private:
+    friend class Scheduler;
+
+    void publish(const Simplex_Progress& snapshot, bool end);
+
+    struct Waiter {
+        int after;
+        function<void()> wake;
+    };
+
+    shared_future<Result> result;
+    atomic<bool> cancelled{false};
+    mutable mutex lock;
+    mutable condition_variable changed;
+    // Latest snapshot, written by the job's thread only; sequence is odd
+    // while it is being written.
+    atomic<unsigned> sequence{0};
+    atomic<int> iteration{0};
+    atomic<double> objective{0};
+    atomic<double> elapsed{0};
+    atomic<double> iteration_time{0};
+    atomic<bool> finished{false};
+    mutable atomic<int> pending{0};     // registered waiters and blocked wait_progress calls
+    vector<Waiter> waiters;
+};
+
+class Scheduler {
+public:
+    explicit Scheduler(int cores = 0);
+    ~Scheduler();
+
+    void set_pinning(bool pin) { pinning = pin; }
+    future<Result> submit(Problem&& problem, const Job_Options& options = Job_Options());
+    shared_ptr<Solve_Task> start(Problem&& problem, const Job_Options& options = Job_Options());
+    void wait();
+
+    int cores() const { return total; }
+    string report() const;
+
+private:
+    struct Job {
+        Problem problem;
+        Job_Options options;
+        long arrival = 0;
+        atomic<int> team{1};
+        atomic<int> first_cpu{0};
+        atomic<int> placement{0};       // bumped when team or first_cpu change
+        promise<Result> done;
+        shared_ptr<Solve_Task> task;    // set by start
+    };
+
+    void queue(Job *job);
+    void run(Job *job);
+    void admit();
+    void share();
+
+    int total;
+    vector<int> cpus;                   // of the process affinity mask
+    bool pinning = false;
+    long arrivals = 0;
+    long finished = 0;
+    mutable mutex lock;
+    condition_variable idle;
+    list<Job *> running;
+    list<Job *> waiting;
+
+    Scheduler(const Scheduler&);
+    Scheduler& operator=(const Scheduler&);
+};
+
+#endif
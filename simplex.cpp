@@ -0,0 +1,1321 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  simplex.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Tableau storage, input parsing, problem generation and the OpenMP
+ *  parallel pivot loop shared by the solver and the benchmark executables.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <iostream>
+#include <cstring>
+#include <random>
+#include <algorithm>
+
+#include "simplex.h"
+#include "telemetry.h"
+#include "trace_events.h"
+#include "sync_stats.h"
+#include "health.h"
+#include "flight_recorder.h"
+#include "metrics.h"
+#include "probes.h"
+
+static const char *kernel_names[KERNEL_COUNT] = {"baseline", "restrict"};
+static const char *phase_names[PHASE_COUNT] = {
+    "ratio", "normalize", "eliminate", "objective", "pricing", "bookkeeping", "barrier"
+};
+static const char *sync_names[SYNC_COUNT] = {"pricing", "ratio", "pivot", "normalize", "objective", "iteration"};
+static const char *status_names[SIMPLEX_STATUS_COUNT] = {"optimal", "unbounded", "iteration limit", "infeasible",
+                                                          "cancelled", "time limit", "target reached"};
+
+/**
+ * Name of a row-update kernel variant.
+ * @param kernel
+ * @return
+ */
+const char * kernel_name(int kernel) {
+    if (kernel < 0 || kernel >= KERNEL_COUNT) return "unknown";
+    return kernel_names[kernel];
+}
+
+/**
+ * Name of a phase of the pivot loop.
+ * @param phase
+ * @return
+ */
+const char * phase_name(int phase) {
+    if (phase < 0 || phase >= PHASE_COUNT) return "unknown";
+    return phase_names[phase];
+}
+
+/**
+ * Name of a synchronization point of the pivot loop.
+ * @param sync
+ * @return
+ */
+const char * sync_name(int sync) {
+    if (sync < 0 || sync >= SYNC_COUNT) return "unknown";
+    return sync_names[sync];
+}
+
+/**
+ * Name of the outcome of a solve.
+ * @param status
+ * @return
+ */
+const char * status_name(int status) {
+    if (status < 0 || status >= SIMPLEX_STATUS_COUNT) return "unknown";
+    return status_names[status];
+}
+
+/**
+ * Row-update kernel variant from its name.
+ * @param name
+ * @return the kernel or -1 when the name is unknown
+ */
+int kernel_from_name(const string& name) {
+    for (int k = 0; k < KERNEL_COUNT; k++)
+        if (name == kernel_names[k]) return k;
+    return -1;
+}
+
+/**
+ * Alocate matrix
+ * @param nL
+ * @param nC
+ * @return a double pointer to pointer
+ */
+double ** alocate_matrix(int nL, int nC) {
+
+    double **tableau = new (nothrow) double *[nL];
+
+    if (tableau == 0) {
+        cerr << "Not possible to alocate matrix\n";
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < nL; i++) {
+        *(tableau + i) = new (nothrow) double[nC];
+        if (*(tableau + i) == 0) {
+            cerr << "Not possible to alocate matrix \n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    return tableau;
+}
+
+/**
+ * Delete matrix
+ * @param tableau
+ * @param nL
+ */
+void delete_matrix(double **tableau, int nL) {
+
+    if (tableau == 0) return;
+
+    for (int i = 0; i < nL; i++) {
+
+        delete [] tableau[i];
+    }
+
+    delete [] tableau;
+}
+
+/**
+ * Copy the contents of a matrix into another one of the same dimensions.
+ * @param dst
+ * @param src
+ * @param nL
+ * @param nC
+ */
+void copy_matrix(double **dst, double **src, int nL, int nC) {
+
+#pragma omp parallel for
+    for (int i = 0; i < nL; i++) {
+        memcpy(dst[i], src[i], nC * sizeof (double));
+    }
+}
+
+/**
+ * Calculate the time spent between a start and a end timespec structure.
+ * @param start
+ * @param end
+ * @return
+ */
+struct timespec My_diff(struct timespec start, struct timespec end) {
+    struct timespec temp;
+
+    if ((end.tv_nsec - start.tv_nsec) < 0) {
+        temp.tv_sec = end.tv_sec - start.tv_sec - 1;
+        temp.tv_nsec = 1000000000 + end.tv_nsec - start.tv_nsec;
+    } else {
+        temp.tv_sec = end.tv_sec - start.tv_sec;
+        temp.tv_nsec = end.tv_nsec - start.tv_nsec;
+    }
+    return temp;
+}
+
+/**
+ * Time spent between a start and a end timespec structure, in seconds.
+ * @param start
+ * @param end
+ * @return
+ */
+double elapsed_seconds(struct timespec start, struct timespec end) {
+    double ONE_SECOND_IN_NANOSECONDS = 1000000000;
+    struct timespec time = My_diff(start, end);
+    return time.tv_sec + (double) time.tv_nsec / ONE_SECOND_IN_NANOSECONDS;
+}
+
+/**
+ * Get the dimension of matrix from file name.
+ * @param argv
+ * @param nL
+ * @param nC
+ */
+void get_dimension(char** argv, int &nL, int &nC) {
+    int dimension[2] = {0, 0}, i = 0;
+
+    char *save = 0;
+    char *pch = strtok_r(argv[1], "x/_", &save);
+    while (pch != NULL) {
+
+        if (i == 1) {
+            dimension[0] = atoi(pch);
+        }
+        if (i == 2) {
+            dimension[1] = atoi(pch);
+        }
+        pch = strtok_r(NULL, "x/_", &save);
+        i++;
+    }
+    nL = dimension[0] + 1;
+    nC = dimension[0] + dimension[1] + 1;
+}
+
+/**
+ * Function to read from the file the information needed for simplex algorithm.
+ * @param argv
+ * @param nL
+ * @param nC
+ * @param stats when set, receives the number of lines read and their lengths
+ * @return
+ */
+double ** read_data(char** argv, int& nL, int& nC, Input_Stats *stats) {
+
+    SIMPLEX_PROBE1(load__start, argv[1]);
+
+    ifstream file(argv[1]);
+
+    if (!file.is_open()) {
+        cerr << "Error opening file";
+        exit(1);
+    }
+
+    get_dimension(argv, nL, nC);
+
+    double ** tableau = alocate_matrix(nL, nC);
+
+    int lin = 0, min_row = nC, max_row = 0;
+    string line;
+    while (getline(file, line)) {
+
+        if (line == "") break;
+
+        vector<double> contraint = string_to_vector<double>(line);
+        copy(contraint.begin(), contraint.end(), tableau[lin]);
+        lin++;
+        min_row = min(min_row, (int) contraint.size());
+        max_row = max(max_row, (int) contraint.size());
+    }
+
+    SIMPLEX_PROBE3(load__end, nL, nC, lin);
+
+    if (stats) {
+        stats->lines = lin;
+        stats->min_row = lin ? min_row : 0;
+        stats->max_row = max_row;
+    }
+
+    return tableau;
+}
+
+/**
+ * Generate a bounded and feasible LP in the same layout as the input files:
+ * positive constraint coefficients with the given density, an identity block
+ * for the slack variables, positive independent values and positive costs.
+ * @param constraints
+ * @param variables
+ * @param density fraction of nonzero coefficients in A, in (0, 1]
+ * @param seed
+ * @param nL
+ * @param nC
+ * @return
+ */
+double ** generate_problem(int constraints, int variables, double density, unsigned seed, int& nL, int& nC) {
+
+    nL = constraints + 1;
+    nC = constraints + variables + 1;
+
+    double ** tableau = alocate_matrix(nL, nC);
+
+    mt19937 gen(seed);
+    uniform_real_distribution<double> coef(1.0, 10.0);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+
+    for (int i = 0; i < nL; i++)
+        memset(tableau[i], 0, nC * sizeof (double));
+
+    for (int i = 0; i < constraints; i++) {
+        for (int j = 0; j < variables; j++)
+            if (unit(gen) < density || j % constraints == i)
+                tableau[i][j] = coef(gen);
+        tableau[i][variables + i] = 1.0;
+        tableau[i][nC - 1] = coef(gen) * variables * density;
+    }
+
+    for (int j = 0; j < variables; j++)
+        tableau[constraints][j] = -coef(gen);
+
+    return tableau;
+}
+
+/**
+ * Pricing: most negative coefficient of the objective row.
+ * @param tableau
+ * @param constraintNumb index of the objective row
+ * @param colNumb index of the independent values column
+ * @param chunk
+ * @param max reduction target, shared by the team
+ * @param fixed when set, the columns that may not enter
+ */
+void pricing_argmax(double **tableau, int constraintNumb, int colNumb, int chunk, Compare_Max &max, const char *fixed) {
+    int j;
+
+#pragma omp for schedule(guided,chunk) reduction(maximo:max) nowait
+    for (j = 0; j < colNumb; j++)
+        if (tableau[constraintNumb][j] < 0.0 && max.val < (-tableau[constraintNumb][j]) && !(fixed && fixed[j])) {
+            max.val = -tableau[constraintNumb][j];
+            max.index = j;
+        }
+}
+
+/**
+ * Ratio test: row with the smallest ratio between the independent value and
+ * a positive coefficient of the entering column.
+ * @param tableau
+ * @param constraintNumb
+ * @param colNumb
+ * @param col entering column
+ * @param chunk
+ * @param tolerance coefficients not above it are not candidate pivots
+ * @param min reduction target, shared by the team
+ * @param count reduction target, number of rows without a candidate pivot
+ */
+void ratio_test_argmin(double **tableau, int constraintNumb, int colNumb, int col, int chunk, double tolerance,
+                       Compare_Min &min, int &count) {
+    double pivot;
+    int i;
+
+#pragma omp for reduction(+:count),reduction(minimo:min) schedule(guided,chunk) nowait //guided e dynamic testar chunck size e reduction <
+    for (i = 0; i < constraintNumb; i++) {
+        if (tableau[i][col] > tolerance) {
+            pivot = tableau[i][colNumb] / tableau[i][col];
+            if (min.val > pivot) {
+                min.val = pivot;
+                min.index = i;
+            }
+        } else
+            count++;
+    }
+}
+
+/**
+ * Divide the pivot row by the pivot element.
+ * @param tableau
+ * @param colNumb
+ * @param row
+ * @param pivot
+ */
+void normalize_pivot_row(double **tableau, int colNumb, int row, double pivot) {
+    int j;
+
+#pragma omp for nowait
+    for (j = 0; j <= (colNumb); j++) {
+        tableau[row][j] = tableau[row][j] / pivot;
+    }
+}
+
+/**
+ * Eliminate the entering column from every constraint row but the pivot row.
+ * @param tableau
+ * @param constraintNumb
+ * @param colNumb
+ * @param row pivot row
+ * @param col pivot column
+ * @param kernel
+ * @param updated reduction target, number of rows actually updated
+ */
+void eliminate_rows(double **tableau, int constraintNumb, int colNumb, int row, int col, int kernel, int &updated) {
+    double pivot2;
+    int i, j;
+
+    if (kernel == KERNEL_RESTRICT) {
+        const double * __restrict pivot_row = tableau[row];
+
+#pragma omp for reduction(+:updated) nowait
+        for (i = 0; i < constraintNumb; i++) {
+            double * __restrict line = tableau[i];
+            pivot2 = -line[col];
+            if (i == row || pivot2 == 0.0) continue;
+            for (j = 0; j <= colNumb; j++) {
+                line[j] += pivot2 * pivot_row[j];
+            }
+            updated++;
+        }
+        return;
+    }
+
+#pragma omp for reduction(+:updated) nowait
+    for (i = 0; i < constraintNumb; i++) {
+        if (i != row) {
+            pivot2 = -tableau[i][col];
+#pragma GCC ivdep
+            for (j = 0; j <= colNumb; j++) {
+                tableau[i][j] = (pivot2 * tableau[row][j]) + tableau[i][j];
+            }
+            updated++;
+        }
+    }
+}
+
+/**
+ * Update the objective row and price the next iteration in the same sweep.
+ * @param tableau
+ * @param constraintNumb
+ * @param colNumb
+ * @param row pivot row
+ * @param pivot3 minus the objective coefficient of the entering column
+ * @param chunk
+ * @param max reduction target, shared by the team
+ * @param conta reduction target, number of negative reduced costs
+ * @param fixed when set, the columns that may not enter
+ */
+void update_objective(double **tableau, int constraintNumb, int colNumb, int row, double pivot3, int chunk, Compare_Max &max, int &conta,
+                      const char *fixed) {
+    int j;
+
+    if (fixed) {
+#pragma omp for reduction(+:conta),reduction(maximo:max) schedule(guided,chunk) nowait
+        for (j = 0; j <= colNumb; j++) {
+            tableau[constraintNumb][j] = (pivot3 * tableau[row][j]) + tableau[constraintNumb][j];
+            if (j < colNumb && tableau[constraintNumb][j] < 0.0 && !fixed[j]) {
+                conta++;
+                if (max.val < (-tableau[constraintNumb][j])) {
+                    max.val = -tableau[constraintNumb][j];
+                    max.index = j;
+                }
+            }
+        }
+        return;
+    }
+
+#pragma omp for reduction(+:conta),reduction(maximo:max) schedule(guided,chunk) nowait
+    for (j = 0; j <= colNumb; j++) {
+        tableau[constraintNumb][j] = (pivot3 * tableau[row][j]) + tableau[constraintNumb][j];
+        if (j < colNumb && tableau[constraintNumb][j] < 0.0) {
+            conta++;
+            if (max.val < (-tableau[constraintNumb][j])) {
+                max.val = -tableau[constraintNumb][j];
+                max.index = j;
+            }
+        }
+    }
+}
+
+/**
+ * Pivot the whole tableau on one element with its own parallel region.
+ * @param tableau
+ * @param constraintNumb
+ * @param colNumb
+ * @param row
+ * @param col
+ * @param kernel
+ */
+void pivot_tableau(double **tableau, int constraintNumb, int colNumb, int row, int col, int kernel) {
+    double pivot = tableau[row][col], pivot3 = -tableau[constraintNumb][col];
+    int updated = 0, conta = 0;
+    struct Compare_Max max;
+
+#pragma omp parallel default(none) shared(tableau,constraintNumb,colNumb,row,col,kernel,pivot,pivot3,updated,conta,max)
+    {
+        normalize_pivot_row(tableau, colNumb, row, pivot);
+#pragma omp barrier
+        eliminate_rows(tableau, constraintNumb, colNumb, row, col, kernel, updated);
+        update_objective(tableau, constraintNumb, colNumb, row, pivot3, 1, max, conta);
+    }
+}
+
+/**
+ * Rebuild the tableau of a basis from the original data by Gauss-Jordan
+ * elimination with partial pivoting. The structural columns are pivoted first;
+ * a slack column that is still a unit column of a free row needs no pivot.
+ * The rows may be permuted, basis receives the variable of every row.
+ * @param tableau
+ * @param original tableau of the slack basis
+ * @param constraintNumb
+ * @param colNumb
+ * @param basis basic variables, one per row
+ * @param kernel
+ * @return false when the basis is numerically singular
+ */
+bool refactor_basis(double **tableau, double **original, int constraintNumb, int colNumb, int *basis, int kernel) {
+    int slack = colNumb - constraintNumb;
+    vector<int> columns(basis, basis + constraintNumb);
+    vector<char> used(constraintNumb, 0);
+
+    copy_matrix(tableau, original, constraintNumb + 1, colNumb + 1);
+    stable_partition(columns.begin(), columns.end(), [slack](int c) { return c < slack; });
+
+    for (size_t k = 0; k < columns.size(); k++) {
+        int col = columns[k], row = -1;
+        double best = 0;
+
+        for (int i = 0; i < constraintNumb; i++)
+            if (!used[i] && fabs(tableau[i][col]) > best) {
+                best = fabs(tableau[i][col]);
+                row = i;
+            }
+        if (row < 0 || best < 1e-12) return false;
+
+        if (col >= slack && best == 1.0 && tableau[row][col] == 1.0) {
+            int nonzero = 0;
+            for (int i = 0; i <= constraintNumb; i++)
+                if (tableau[i][col] != 0.0) nonzero++;
+            if (nonzero == 1) {
+                used[row] = 1;
+                basis[row] = col;
+                continue;
+            }
+        }
+
+        pivot_tableau(tableau, constraintNumb, colNumb, row, col, kernel);
+        used[row] = 1;
+        basis[row] = col;
+    }
+    return true;
+}
+
+/**
+ * Rebuild the objective row of a basis from the objective row of the slack
+ * basis: -c_k + c_B B^-1 a_k for every column. Each thread takes a block of
+ * columns.
+ * @param tableau
+ * @param constraintNumb
+ * @param colNumb
+ * @param costs objective row of the slack basis, colNumb + 1 values
+ * @param basis basic variable of every row
+ */
+void reprice_objective(double **tableau, int constraintNumb, int colNumb, const double *costs, const int *basis) {
+    int cols = colNumb + 1;
+    double *objective = tableau[constraintNumb];
+
+    for (int k = 0; k < cols; k++) objective[k] = costs[k];
+
+#pragma omp parallel
+    {
+        int t = omp_get_thread_num(), team = omp_get_num_threads();
+        int first = (long) cols * t / team, last = (long) cols * (t + 1) / team;
+        for (int r = 0; r < constraintNumb; r++) {
+            double cost = costs[basis[r]];
+            if (cost == 0.0) continue;
+            for (int k = first; k < last; k++)
+                objective[k] -= cost * tableau[r][k];
+        }
+    }
+}
+
+/**
+ * Upper bound of the optimal objective at a basis. With the reduced costs d_k
+ * of the objective row, the objective of every solution of the constraints is
+ * z - sum d_k x_k, so only the columns with d_k < 0 can raise it. Two bounds
+ * are taken from the original data, the smaller is returned:
+ *  - weak duality: raising the dual of row i by t = max -d_k / a_ik over those
+ *    columns gives a dual feasible point when a_ik > 0 in all of them and no
+ *    other reduced cost turns negative; its objective is z + t b_i.
+ *  - the largest value of each of those columns on the rows with no negative
+ *    coefficient, b_i / a_ik, and b_i for the slack of such a row.
+ * The slack coefficients come from the original data, so >= and = rows are
+ * accounted; the slacks of = rows are fixed at zero and never raise it.
+ * The rows are split among the threads.
+ * @param tableau tableau of the basis
+ * @param original tableau of the slack basis
+ * @param constraintNumb
+ * @param colNumb
+ * @return HUGE_VAL when neither bound exists
+ */
+double objective_bound(double **tableau, double **original, int constraintNumb, int colNumb) {
+    int variables = colNumb - constraintNumb;
+    double *d = tableau[constraintNumb], z = d[colNumb], dual = HUGE_VAL;
+    vector<int> improving;
+    vector<double> upper;
+
+    for (int k = 0; k < colNumb; k++)
+        if (d[k] < 0 && (k < variables || original[k - variables][k] != 0)) improving.push_back(k);
+    if (improving.empty()) return z;
+    upper.assign(improving.size(), HUGE_VAL);
+
+#pragma omp parallel default(none) shared(original,constraintNumb,colNumb,variables,d,z,improving,upper) reduction(min:dual)
+    {
+        vector<double> largest(improving.size(), HUGE_VAL);
+        int i, k;
+        size_t q;
+
+#pragma omp for schedule(static) nowait
+        for (i = 0; i < constraintNumb; i++) {
+            const double *a = original[i];
+            double t = 0;
+            int slack = variables + i;
+            bool nonnegative = a[colNumb] >= 0 && a[slack] >= 0, feasible = true;
+
+            for (k = 0; k < variables && nonnegative; k++)
+                nonnegative = a[k] >= 0;
+            for (q = 0; q < improving.size(); q++) {
+                k = improving[q];
+                double coefficient = k < variables || k == slack ? a[k] : 0.0;
+                if (coefficient <= 0) {
+                    feasible = false;
+                    continue;
+                }
+                t = std::max(t, -d[k] / coefficient);
+                if (nonnegative) largest[q] = std::min(largest[q], a[colNumb] / coefficient);
+            }
+            for (k = 0; k < variables && feasible; k++)
+                feasible = a[k] >= 0 || d[k] + t * a[k] >= 0;
+            feasible = feasible && (a[slack] >= 0 || d[slack] + t * a[slack] >= 0);
+            if (feasible) dual = std::min(dual, z + t * a[colNumb]);
+        }
+
+#pragma omp critical
+        for (q = 0; q < improving.size(); q++)
+            upper[q] = std::min(upper[q], largest[q]);
+    }
+
+    double primal = z;
+    for (size_t q = 0; q < improving.size() && primal < HUGE_VAL; q++)
+        primal = upper[q] == HUGE_VAL ? HUGE_VAL : primal - d[improving[q]] * upper[q];
+    return std::min(dual, primal);
+}
+
+/**
+ * Per-thread clock of the pivot loop. It charges the time since the previous
+ * mark to a phase and performs the barriers, timing the wait when some
+ * consumer (telemetry, trace, sync accounting) is attached; otherwise it only
+ * synchronizes.
+ */
+struct Phase_Clock {
+    Trace_Recorder *trace = 0;
+    Sync_Stats *stats = 0;
+    bool timed = false;
+    bool sampled = false;
+    int tid = 0;
+    int iteration = 0;
+    double last = 0;
+    double released = 0;    // departure from the previous barrier
+    double spent[PHASE_COUNT] = {};
+    double total[PHASE_COUNT] = {};
+    double waited[SYNC_COUNT] = {};
+
+    void start(int ni) {
+        iteration = ni;
+        if (!timed) return;
+        sampled = trace && trace->sampled(ni);
+        for (int k = 0; k < PHASE_COUNT; k++) spent[k] = 0;
+        last = omp_get_wtime();
+    }
+
+    void phase(int p) {
+        SIMPLEX_PROBE3(phase, tid, iteration, p);
+        if (!timed) return;
+        double now = omp_get_wtime();
+        spent[p] += now - last;
+        total[p] += now - last;
+        if (sampled) trace->record(tid, p, iteration, last, now);
+        last = now;
+    }
+
+    void sync(int point) {
+        if (!timed) {
+            SIMPLEX_PROBE3(sync__begin, tid, iteration, point);
+#pragma omp barrier
+            SIMPLEX_PROBE3(sync__end, tid, iteration, point);
+            return;
+        }
+        double arrive = omp_get_wtime();
+        if (stats) stats->arrive(tid, point, arrive, arrive - released);
+        SIMPLEX_PROBE3(sync__begin, tid, iteration, point);
+#pragma omp barrier
+        SIMPLEX_PROBE3(sync__end, tid, iteration, point);
+        double depart = omp_get_wtime();
+        spent[PHASE_BARRIER] += depart - arrive;
+        total[PHASE_BARRIER] += depart - arrive;
+        waited[point] += depart - arrive;
+        if (sampled) trace->record(tid, PHASE_COUNT + point, iteration, arrive, depart);
+        if (stats) {
+            stats->depart(tid, point, depart - arrive);
+            if (tid == 0) stats->close(point);
+        }
+        last = released = depart;
+    }
+};
+
+/**
+ * Parallel simplex pivot loop. The number of threads is opt.threads, or the
+ * one set with omp_set_num_threads when it is 0. The loop runs in segments,
+ * one parallel region each; a segment ends when the solve ends or when the
+ * tableau must be rebuilt between two iterations.
+ * @param tableau
+ * @param constraintNumb index of the objective row
+ * @param colNumb index of the independent values column
+ * @param opt
+ * @return the number of iterations
+ */
+int simplex(double **tableau, int constraintNumb, int colNumb, const Simplex_Options& opt) {
+    int count = 0, conta = 0, ni = 0, divergences = 0, updated = 0, segment = 0;
+    long rows_updated = 0, ratio_rows = 0;
+    int chunk = opt.chunk, kernel = opt.kernel;
+    double tolerance = opt.pivot_tolerance;
+    bool restart = false, recompute = false, unbounded = false, stopped = false, timed_out = false, reached = false;
+    double started = omp_get_wtime(), previous = started;
+    double time_limit = opt.time_limit, target = opt.target;
+    int team = opt.threads > 0 ? opt.threads : omp_get_max_threads();
+    const atomic<int> *team_size = opt.sync_stats ? 0 : opt.team_size;
+    const atomic<int> *placement = opt.sync_stats ? 0 : opt.placement;
+    int generation = 0;
+    int limit = opt.max_iterations;
+    const vector<Pivot> *replay = opt.replay;
+    bool search = !replay || !opt.replay_skip_search;
+    Telemetry *telemetry = opt.telemetry && opt.telemetry->iterations_enabled() ? opt.telemetry : 0;
+    Trace_Recorder *trace = opt.trace && opt.trace->enabled() ? opt.trace : 0;
+    Sync_Stats *stats = opt.sync_stats;
+    Solve_Profile *profile = opt.profile;
+    Health_Monitor *health = opt.health && opt.health->enabled() ? opt.health : 0;
+    Flight_Recorder *flight = opt.flight && opt.flight->enabled() ? opt.flight : 0;
+    Metrics_Exporter *metrics = opt.metrics;
+    double phase_total[PHASE_COUNT] = {}, wait_total[SYNC_COUNT] = {};
+
+    struct Compare_Max max;
+    struct Compare_Min min;
+
+    if (opt.status) *opt.status = SIMPLEX_OPTIMAL;
+    if (replay && replay->empty()) return 0;
+    if (opt.cancel && opt.cancel->load()) {
+        if (opt.status) *opt.status = SIMPLEX_CANCELLED;
+        return 0;
+    }
+    if (team_size) team = std::max(1, team_size->load());
+    if (trace) trace->prepare(team);
+    if (health) health->start(tableau, constraintNumb, colNumb, tolerance);
+    if (flight) flight->start();
+    if (metrics) metrics->start(team, constraintNumb, colNumb - constraintNumb);
+
+    do {
+        restart = recompute = false;
+        max = Compare_Max();
+        if (placement) generation = placement->load();
+
+#pragma omp parallel num_threads(team) default(none) shared(min,max,chunk,count,tableau,conta,colNumb,constraintNumb,ni,kernel,opt,replay,search,divergences,telemetry,trace,stats,profile,updated,rows_updated,ratio_rows,health,flight,metrics,tolerance,restart,recompute,unbounded,limit,segment,phase_total,wait_total,team,team_size,placement,generation,stopped,started,previous,time_limit,target,timed_out,reached)
+        {
+            double pivot, pivot3;
+            int row, col, searched;
+            bool more;
+            Phase_Clock clock;
+
+            clock.trace = trace;
+            clock.stats = stats;
+            clock.timed = telemetry || trace || stats || profile || metrics;
+            clock.tid = omp_get_thread_num();
+
+            if (opt.on_segment) opt.on_segment(clock.tid);
+
+            if (stats && segment == 0) {
+#pragma omp single
+                stats->prepare(omp_get_num_threads(), chunk);
+            }
+
+            clock.start(ni);
+            clock.released = clock.last;
+
+            if (search)
+                pricing_argmax(tableau, constraintNumb, colNumb, chunk, max, opt.fixed);
+
+            clock.phase(PHASE_PRICING);
+            clock.sync(SYNC_PRICING);
+
+            more = (replay ? ni < (int) replay->size() : max.index >= 0) && (!limit || ni < limit);
+
+#pragma omp single nowait
+            {
+                max.val = 0;
+                // The final status reads conta, and a segment that starts
+                // optimal (e.g. after a recompute) runs no iteration to set it.
+                conta = max.index >= 0;
+            }
+
+            while (more) {
+
+                if (clock.tid == 0) SIMPLEX_PROBE1(iteration__start, ni);
+
+                if (search)
+                    ratio_test_argmin(tableau, constraintNumb, colNumb, replay ? (*replay)[ni].entering : max.index, chunk,
+                                      tolerance, min, count);
+
+                clock.phase(PHASE_RATIO);
+                clock.sync(SYNC_RATIO);
+
+                // Every thread reads the same reduced count, so the team leaves
+                // the loop together; count is reset in the bookkeeping below.
+                if (!replay && count == constraintNumb) {
+                    if (clock.tid == 0) {
+                        unbounded = true;
+                        SIMPLEX_PROBE2(unbounded, ni, max.index);
+                        if (flight) flight->dump("unbounded");
+                    }
+                    break;
+                }
+
+#pragma omp single nowait //testar com mais singles
+                conta = 0;
+
+                // Private copies: the objective update below reduces into 'max'
+                // while other threads may still be eliminating rows.
+                searched = max.index;
+                if (replay) {
+                    row = (*replay)[ni].leaving;
+                    col = (*replay)[ni].entering;
+                } else {
+                    row = min.index;
+                    col = max.index;
+                }
+                pivot = tableau[row][col];
+                // A recorded pivot that does not fit this tableau ends the
+                // replay; every thread reads the same element.
+                if (replay && pivot == 0) break;
+                pivot3 = -tableau[constraintNumb][col];
+                if (clock.tid == 0) SIMPLEX_PROBE4(pivot, ni, col, row, pivot);
+
+                clock.phase(PHASE_BOOKKEEPING);
+                clock.sync(SYNC_PIVOT);
+
+                normalize_pivot_row(tableau, colNumb, row, pivot);
+
+                clock.phase(PHASE_NORMALIZE);
+                clock.sync(SYNC_NORMALIZE);
+
+                eliminate_rows(tableau, constraintNumb, colNumb, row, col, kernel, updated);
+
+                clock.phase(PHASE_ELIMINATE);
+
+                update_objective(tableau, constraintNumb, colNumb, row, pivot3, chunk, max, conta, opt.fixed);
+
+                clock.phase(PHASE_OBJECTIVE);
+                clock.sync(SYNC_OBJECTIVE);
+
+#pragma omp single nowait
+                {
+                    if (telemetry) {
+                        Iteration_Record rec;
+                        rec.iteration = ni;
+                        rec.entering = col;
+                        rec.leaving = row;
+                        rec.pivot = pivot;
+                        rec.step = tableau[row][colNumb];
+                        rec.objective = tableau[constraintNumb][colNumb];
+                        for (int k = 0; k < PHASE_COUNT; k++)
+                            rec.phase[k] = clock.spent[k];
+                        telemetry->iteration(rec);
+                    }
+                    if (replay && search && (searched != col || min.index != row))
+                        divergences++;
+                    if (opt.record) {
+                        Pivot p = {col, row};
+                        opt.record->push_back(p);
+                    }
+                    if (opt.basis) opt.basis[row] = col;
+                    if (search) ratio_rows += constraintNumb - count;
+                    count = 0;
+                    SIMPLEX_PROBE4(iteration__end, ni, col, row, tableau[constraintNumb][colNumb]);
+                    ni++;
+                    int actions = 0;
+                    if (health) {
+                        health->pivot(row, col, pivot);
+                        if (health->due(ni)) {
+                            actions = health->check(tableau, ni);
+                            if (actions & HEALTH_TIGHTEN) tolerance = health->tighten(tolerance);
+                            if (actions & HEALTH_RECOMPUTE) recompute = restart = true;
+                            if (metrics) metrics->health(health->metrics());
+                        }
+                    }
+                    if (metrics) metrics->iteration(ni, tableau[constraintNumb][colNumb], clock.spent);
+                    if (flight) {
+                        Flight_Entry entry = {};
+                        entry.iteration = ni - 1;
+                        entry.entering = col;
+                        entry.leaving = row;
+                        entry.pivot = pivot;
+                        entry.objective = tableau[constraintNumb][colNumb];
+                        entry.step = tableau[row][colNumb];
+                        if (health) {
+                            const Health_Metrics& h = health->metrics();
+                            entry.growth = h.growth;
+                            entry.primal_residual = h.primal_residual;
+                            entry.dual_residual = h.dual_residual;
+                            entry.near_zero_pivots = h.near_zero_pivots;
+                        }
+                        flight->record(entry);
+                        if (actions) flight->dump("health check");
+                    }
+                    if (team_size && team_size->load(memory_order_relaxed) != team) restart = true;
+                    if (placement && placement->load(memory_order_relaxed) != generation) restart = true;
+                    if (target < HUGE_VAL && tableau[constraintNumb][colNumb] >= target) reached = stopped = true;
+                    if (opt.on_progress || opt.cancel || time_limit > 0) {
+                        double now = omp_get_wtime();
+                        Simplex_Progress progress;
+                        progress.iteration = ni;
+                        progress.objective = tableau[constraintNumb][colNumb];
+                        progress.elapsed = now - started;
+                        progress.iteration_time = now - previous;
+                        previous = now;
+                        if (opt.on_progress && opt.on_progress(progress)) stopped = true;
+                        if (opt.cancel && opt.cancel->load(memory_order_relaxed)) stopped = true;
+                        if (time_limit > 0 && progress.elapsed >= time_limit) timed_out = stopped = true;
+                    }
+                    rows_updated += updated;
+                    updated = 0;
+                    max.val = 0.0;
+                    min.val = HUGE_VAL;
+                }
+
+                clock.phase(PHASE_BOOKKEEPING);
+                clock.sync(SYNC_ITERATION);
+                clock.start(ni);
+
+                more = !restart && !stopped && (replay ? ni < (int) replay->size() : conta) && (!limit || ni < limit);
+            }
+
+            if (clock.tid == 0) {
+                for (int k = 0; k < PHASE_COUNT; k++) phase_total[k] += clock.total[k];
+                for (int k = 0; k < SYNC_COUNT; k++) wait_total[k] += clock.waited[k];
+                if (profile) profile->threads = omp_get_num_threads();
+            }
+        }
+
+        if (recompute) {
+            if (!health->recompute(tableau, kernel))
+                health->alarm("health: singular basis at iteration " + to_string(ni) + ", recompute abandoned");
+            else if (opt.basis)
+                copy(health->basis(), health->basis() + constraintNumb, opt.basis);
+        }
+        if (team_size && team_size->load() != team) {
+            team = std::max(1, team_size->load());
+            if (trace) trace->prepare(team);
+        }
+        segment++;
+    } while (restart && !stopped);
+
+    if (metrics) metrics->finish();
+
+    if (profile) {
+        for (int k = 0; k < PHASE_COUNT; k++) profile->phase[k] = phase_total[k];
+        for (int k = 0; k < SYNC_COUNT; k++) profile->wait[k] = wait_total[k];
+        profile->iterations = ni;
+        profile->rows_updated = rows_updated;
+        profile->ratio_rows = ratio_rows;
+        profile->searched = search;
+    }
+
+    if (opt.status) {
+        if (unbounded) *opt.status = SIMPLEX_UNBOUNDED;
+        else if (stopped && (replay || conta))
+            *opt.status = timed_out ? SIMPLEX_TIME_LIMIT : reached ? SIMPLEX_TARGET_REACHED : SIMPLEX_CANCELLED;
+        else if (!replay && conta) *opt.status = SIMPLEX_ITERATION_LIMIT;
+        else if (replay && ni < (int) replay->size()) *opt.status = SIMPLEX_ITERATION_LIMIT;
+    }
+
+    if (opt.divergences) *opt.divergences = divergences;
+    return ni;
+}
+
+/**
+ * Dual simplex on a dual feasible tableau (no negative reduced cost), from
+ * the basis it holds: the leaving row has the most negative independent value
+ * and the entering column the smallest ratio between its reduced cost and the
+ * magnitude of a negative coefficient of that row. The searches are reductions
+ * of the team; each pivot is a pivot_tableau. Only threads, kernel, record,
+ * basis, max_iterations, time_limit, on_progress, cancel, fixed and status are used
+ * from the options; a stopped loop leaves a basis that may be primal
+ * infeasible.
+ * @param tableau
+ * @param constraintNumb index of the objective row
+ * @param colNumb index of the independent values column
+ * @param opt
+ * @return the number of iterations; status SIMPLEX_INFEASIBLE when a row with
+ *  a negative independent value has no negative coefficient
+ */
+int dual_simplex(double **tableau, int constraintNumb, int colNumb, const Simplex_Options& opt) {
+    int ni = 0, team = opt.threads > 0 ? opt.threads : omp_get_max_threads();
+    const double tolerance = 1e-9;
+    double started = omp_get_wtime(), previous = started;
+
+    if (opt.status) *opt.status = SIMPLEX_OPTIMAL;
+
+    for (;;) {
+        struct Compare_Min leave, enter;
+
+#pragma omp parallel num_threads(team) default(none) shared(tableau,constraintNumb,colNumb,leave,enter,tolerance,opt)
+        {
+            int i, j;
+
+#pragma omp for reduction(minimo:leave)
+            for (i = 0; i < constraintNumb; i++)
+                if (tableau[i][colNumb] < -tolerance && tableau[i][colNumb] < leave.val) {
+                    leave.val = tableau[i][colNumb];
+                    leave.index = i;
+                }
+
+            if (leave.index >= 0) {
+                double *row = tableau[leave.index];
+#pragma omp for reduction(minimo:enter)
+                for (j = 0; j < colNumb; j++)
+                    if (row[j] < -tolerance && !(opt.fixed && opt.fixed[j]) && tableau[constraintNumb][j] / -row[j] < enter.val) {
+                        enter.val = tableau[constraintNumb][j] / -row[j];
+                        enter.index = j;
+                    }
+            }
+        }
+
+        if (leave.index < 0) break;
+        if (enter.index < 0) {
+            if (opt.status) *opt.status = SIMPLEX_INFEASIBLE;
+            break;
+        }
+        if (opt.max_iterations && ni >= opt.max_iterations) {
+            if (opt.status) *opt.status = SIMPLEX_ITERATION_LIMIT;
+            break;
+        }
+        if (opt.cancel && opt.cancel->load()) {
+            if (opt.status) *opt.status = SIMPLEX_CANCELLED;
+            break;
+        }
+        if (opt.time_limit > 0 && omp_get_wtime() - started >= opt.time_limit) {
+            if (opt.status) *opt.status = SIMPLEX_TIME_LIMIT;
+            break;
+        }
+
+        pivot_tableau(tableau, constraintNumb, colNumb, leave.index, enter.index, opt.kernel);
+        if (opt.basis) opt.basis[leave.index] = enter.index;
+        if (opt.record) {
+            Pivot p = {enter.index, leave.index};
+            opt.record->push_back(p);
+        }
+        ni++;
+        if (opt.on_progress) {
+            double now = omp_get_wtime();
+            Simplex_Progress progress;
+            progress.iteration = ni;
+            progress.objective = tableau[constraintNumb][colNumb];
+            progress.elapsed = now - started;
+            progress.iteration_time = now - previous;
+            previous = now;
+            if (opt.on_progress(progress)) {
+                if (opt.status) *opt.status = SIMPLEX_CANCELLED;
+                break;
+            }
+        }
+    }
+    return ni;
+}
+
+/**
+ * Whether the slack basis of a tableau in the input layout is a feasible start
+ * for the pivot loop: every slack coefficient is 1 (only <= rows) and no
+ * independent value is negative.
+ * @param tableau
+ * @param constraintNumb
+ * @param colNumb
+ * @return
+ */
+bool slack_basis_feasible(double **tableau, int constraintNumb, int colNumb) {
+    int variables = colNumb - constraintNumb;
+
+    for (int i = 0; i < constraintNumb; i++)
+        if (tableau[i][variables + i] != 1.0 || tableau[i][colNumb] < 0) return false;
+    return true;
+}
+
+/**
+ * First phase of the two-phase method, from the slack basis of a tableau in
+ * the input layout. The slack of an = row (coefficient 0) is put back with
+ * coefficient 1 and fixed at zero. A row with a negative independent value is
+ * negated; a row whose slack then has a negative coefficient gets an
+ * artificial variable. The pivot loop minimizes the sum of the artificial
+ * variables and of the basic fixed slacks on the tableau widened by the
+ * artificial columns, none of which may enter. Those still basic at zero are
+ * then pivoted out, onto a fixed slack when their row is redundant, and the
+ * artificial columns are dropped: the tableau holds the feasible basis and
+ * its objective row, repriced with the costs. Health checks, replays and
+ * records, and the target do not apply to this phase; the progress reports
+ * minus the sum being minimized.
+ * @param tableau
+ * @param constraintNumb index of the objective row
+ * @param colNumb index of the independent values column
+ * @param opt basis, when set, receives the basis
+ * @param fixed receives 1 for the slack of every = row, colNumb values
+ * @return the number of iterations; status SIMPLEX_INFEASIBLE when the
+ *  constraints have no solution, or the status of a stopped loop, with no
+ *  feasible basis
+ */
+int phase_one(double **tableau, int constraintNumb, int colNumb, const Simplex_Options& opt, char *fixed) {
+    int m = constraintNumb, variables = colNumb - m, artificials = 0, ni;
+    Simplex_Status status = SIMPLEX_OPTIMAL;
+    Simplex_Options o = opt;
+    vector<double> costs(tableau[m], tableau[m] + colNumb + 1);
+    vector<int> basis(m), artificial(m, -1);
+
+    memset(fixed, 0, colNumb);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < m; i++) {
+        double *row = tableau[i];
+        int slack = variables + i;
+        if (row[slack] == 0.0) {
+            fixed[slack] = 1;
+            row[slack] = 1.0;
+        }
+        if (row[colNumb] < 0 || (row[colNumb] == 0 && row[slack] < 0))
+            for (int j = 0; j <= colNumb; j++) row[j] = -row[j];
+    }
+    for (int i = 0; i < m; i++) {
+        basis[i] = variables + i;
+        if (tableau[i][variables + i] < 0) artificial[i] = artificials++;
+    }
+
+    int width = colNumb + artificials;
+    double **t = tableau;
+    if (artificials) {
+        t = alocate_matrix(m + 1, width + 1);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i <= m; i++) {
+            memcpy(t[i], tableau[i], colNumb * sizeof (double));
+            memset(t[i] + colNumb, 0, artificials * sizeof (double));
+            t[i][width] = tableau[i][colNumb];
+            if (i < m && artificial[i] >= 0) {
+                t[i][colNumb + artificial[i]] = 1.0;
+                basis[i] = colNumb + artificial[i];
+            }
+        }
+    }
+
+    vector<char> barred(width, 1);
+    vector<double> infeasibility(width + 1, 0.0);
+    copy(fixed, fixed + colNumb, barred.begin());
+    for (int k = 0; k < width; k++)
+        if (barred[k]) infeasibility[k] = 1.0;
+    reprice_objective(t, m, width, infeasibility.data(), basis.data());
+    double scale = 1 - t[m][width];
+
+    o.basis = basis.data();
+    o.status = &status;
+    o.fixed = barred.data();
+    o.target = HUGE_VAL;
+    o.replay = 0;
+    o.record = 0;
+    o.health = 0;
+    ni = simplex(t, m, width, o);
+
+    if (status == SIMPLEX_OPTIMAL && -t[m][width] > 1e-9 * scale) status = SIMPLEX_INFEASIBLE;
+
+    for (int r = 0; r < m && status == SIMPLEX_OPTIMAL; r++) {
+        if (!barred[basis[r]]) continue;
+        int col = -1;
+        double best = 1e-7;
+        for (int j = 0; j < colNumb; j++)
+            if (!barred[j] && fabs(t[r][j]) > best) {
+                best = fabs(t[r][j]);
+                col = j;
+            }
+        // A redundant row, a combination of = rows: a fixed slack takes it
+        // and stays basic at zero, as no column that can enter touches it.
+        for (int j = 0; col < 0 && basis[r] >= colNumb && j < colNumb; j++)
+            if (barred[j] && fabs(t[r][j]) > best) {
+                best = fabs(t[r][j]);
+                col = j;
+            }
+        if (col < 0) continue;
+        t[r][width] = 0.0;
+        pivot_tableau(t, m, width, r, col, opt.kernel);
+        basis[r] = col;
+        ni++;
+    }
+
+    if (artificials) {
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < m; i++) {
+            memcpy(tableau[i], t[i], colNumb * sizeof (double));
+            tableau[i][colNumb] = t[i][width];
+        }
+        delete_matrix(t, m + 1);
+    }
+    if (status == SIMPLEX_OPTIMAL) reprice_objective(tableau, m, colNumb, costs.data(), basis.data());
+
+    if (opt.basis) copy(basis.begin(), basis.end(), opt.basis);
+    if (opt.status) *opt.status = status;
+    return ni;
+}
+
+/**
+ * Triangular crash: brings structural columns into the slack basis of a
+ * tableau in the input layout, every slack coefficient 1 and no negative
+ * independent value, before the pivot loop. The columns of positive cost are
+ * taken by decreasing cost, the sparser first on ties, and each one enters on
+ * the row of the ratio test over the rows not taken yet when its pivot is not
+ * small against the largest coefficient of the column; a column with a
+ * nonzero on a row taken is skipped. The basis matrix is then triangular,
+ * every column enters as in a pivot of the loop and the basis stays primal
+ * feasible. The basis is applied only when it covers at least 5% of the rows.
+ * The column counts are computed by the team; the tableau is brought to the
+ * basis by a single batched update, the pivot rows by forward substitution,
+ * then every other row, the objective included, at once from its original
+ * coefficients.
+ * @param tableau
+ * @param constraintNumb index of the objective row
+ * @param colNumb index of the independent values column
+ * @param opt threads and kernel; basis, when set, receives the basis
+ * @return the number of structural columns in the basis, 0 when it is not
+ *  applied
+ */
+int crash_basis(double **tableau, int constraintNumb, int colNumb, const Simplex_Options& opt) {
+    int m = constraintNumb, variables = colNumb - m, team = opt.threads > 0 ? opt.threads : omp_get_max_threads();
+    const double relative = 0.01, coverage = 0.05;
+    vector<int> nonzeros(variables, 0), candidates;
+    vector<double> largest(variables, 0.0);
+
+#pragma omp parallel num_threads(team)
+    {
+        vector<int> count(variables, 0);
+        vector<double> big(variables, 0.0);
+#pragma omp for schedule(static) nowait
+        for (int i = 0; i < m; i++) {
+            const double *row = tableau[i];
+            for (int j = 0; j < variables; j++)
+                if (row[j] != 0.0) {
+                    count[j]++;
+                    big[j] = max(big[j], fabs(row[j]));
+                }
+        }
+#pragma omp critical
+        for (int j = 0; j < variables; j++) {
+            nonzeros[j] += count[j];
+            largest[j] = max(largest[j], big[j]);
+        }
+    }
+
+    const double *cost = tableau[m];
+    for (int j = 0; j < variables; j++)
+        if (cost[j] < 0 && nonzeros[j] > 0) candidates.push_back(j);
+    sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+        if (cost[a] != cost[b]) return cost[a] < cost[b];
+        if (nonzeros[a] != nonzeros[b]) return nonzeros[a] < nonzeros[b];
+        return a < b;
+    });
+
+    // Greedy choice on the values of the basic variables, without touching
+    // the tableau: the coefficients of a column that may enter are still the
+    // original ones on the rows not taken.
+    vector<double> value(m);
+    vector<char> taken(m, 0), blocked(variables, 0);
+    vector<int> rows, cols;
+    for (int i = 0; i < m; i++) value[i] = tableau[i][colNumb];
+    for (int j : candidates) {
+        if (blocked[j]) continue;
+        int row = -1;
+        double ratio = HUGE_VAL;
+        for (int i = 0; i < m; i++) {
+            double a = tableau[i][j];
+            if (!taken[i] && a > 0 && value[i] / a < ratio) {
+                ratio = value[i] / a;
+                row = i;
+            }
+        }
+        if (row < 0 || tableau[row][j] < relative * largest[j]) continue;
+        taken[row] = 1;
+        rows.push_back(row);
+        cols.push_back(j);
+        for (int i = 0; i < m; i++)
+            if (!taken[i] && tableau[i][j] != 0.0) value[i] = max(0.0, value[i] - tableau[i][j] * ratio);
+        const double *pivot = tableau[row];
+        for (int k = 0; k < variables; k++)
+            if (pivot[k] != 0.0) blocked[k] = 1;
+    }
+
+    // A handful of columns does not shorten the path of the pivot loop, and
+    // on dense problems it often lengthens it.
+    int K = rows.size();
+    if (K == 0 || K < coverage * m) return 0;
+
+    // Coefficients of the earlier columns on every pivot row, and the pivots,
+    // read before the update.
+    vector<vector<pair<int, double>>> earlier(K);
+    vector<double> pivots(K);
+    vector<int> position(m, -1);
+    for (int p = 0; p < K; p++) position[rows[p]] = p;
+#pragma omp parallel for num_threads(team) schedule(dynamic, 16)
+    for (int p = 0; p < K; p++) {
+        const double *row = tableau[rows[p]];
+        for (int q = 0; q < p; q++)
+            if (row[cols[q]] != 0.0) earlier[p].push_back(make_pair(q, row[cols[q]]));
+        pivots[p] = row[cols[p]];
+    }
+
+#pragma omp parallel num_threads(team)
+    {
+        int t = omp_get_thread_num(), size = omp_get_num_threads();
+        int first = (long) (colNumb + 1) * t / size, last = (long) (colNumb + 1) * (t + 1) / size;
+
+        // Forward substitution, each thread on its own block of columns.
+        for (int p = 0; p < K; p++) {
+            double *row = tableau[rows[p]];
+            for (const pair<int, double>& e : earlier[p]) {
+                const double *pivot = tableau[rows[e.first]];
+                for (int k = first; k < last; k++) row[k] -= e.second * pivot[k];
+            }
+            for (int k = first; k < last; k++) row[k] /= pivots[p];
+        }
+
+#pragma omp barrier
+        vector<pair<int, double>> coefficients;
+#pragma omp for schedule(dynamic, 8)
+        for (int i = 0; i <= m; i++) {
+            if (i < m && position[i] >= 0) continue;
+            double *row = tableau[i];
+            coefficients.clear();
+            for (int p = 0; p < K; p++)
+                if (row[cols[p]] != 0.0) coefficients.push_back(make_pair(p, row[cols[p]]));
+            for (const pair<int, double>& e : coefficients) {
+                const double *pivot = tableau[rows[e.first]];
+                for (int k = 0; k <= colNumb; k++) row[k] -= e.second * pivot[k];
+            }
+        }
+    }
+
+    if (opt.basis)
+        for (int p = 0; p < K; p++) opt.basis[rows[p]] = cols[p];
+    return K;
+}
@@ -0,0 +1,321 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  simplex.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Shared pieces of the multicore parallel simplex: tableau storage,
+ *  input parsing, problem generation and the OpenMP pivot loop with its kernels.
+ * @language: C++
+ *
+ * @section Description
+ *  The tableau is stored as an array of row pointers. Row 'constraintNumb' is the
+ *  objective row and column 'colNumb' holds the independent values, exactly as in
+ *  the input file layout:
+ *
+ *  | A  b|
+ *  |-c  0|
+ *
+ *  The last constraintNumb columns of A are the slack variables, an identity
+ *  block for <= rows; a coefficient of -1 there makes row i a >= row (a surplus
+ *  variable) and 0 an = row. When that slack basis is not feasible, phase_one
+ *  finds a feasible basis before the pivot loop; when it is feasible,
+ *  crash_basis can replace slacks by structural columns before the loop.
+ *
+ *  The kernels below contain orphaned worksharing directives, so they must be
+ *  called by every thread of an enclosing parallel region. None of them ends
+ *  with a barrier: the caller synchronizes the team, and the reduction targets
+ *  hold the result only after that barrier.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef SIMPLEX_H
+#define SIMPLEX_H
+
+#include <stdlib.h>
+#include <omp.h>
+#include <atomic>
+#include <functional>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <math.h>
+#include <string>
+
+#include "time.h"
+#include "pivot_trace.h"
+
+using namespace std;
+
+class Telemetry;
+class Trace_Recorder;
+class Sync_Stats;
+class Health_Monitor;
+class Flight_Recorder;
+class Metrics_Exporter;
+
+struct Compare_Max {
+    double val = 0;
+    int index = -1;
+};
+
+struct Compare_Min {
+    double val = HUGE_VAL;
+    int index = -1;
+};
+
+/**
+ * Reduction combiners. Ties go to the lowest index (an unset index, -1, is
+ * the largest as unsigned), so the result depends neither on the schedule nor
+ * on the number of threads.
+ */
+inline const Compare_Max& better_max(const Compare_Max& a, const Compare_Max& b) {
+    if (a.val != b.val) return a.val > b.val ? a : b;
+    return (unsigned) a.index < (unsigned) b.index ? a : b;
+}
+
+inline const Compare_Min& better_min(const Compare_Min& a, const Compare_Min& b) {
+    if (a.val != b.val) return a.val < b.val ? a : b;
+    return (unsigned) a.index < (unsigned) b.index ? a : b;
+}
+
+#pragma omp declare reduction(minimo : struct Compare_Min : omp_out = better_min(omp_in, omp_out))
+#pragma omp declare reduction(maximo : struct Compare_Max : omp_out = better_max(omp_in, omp_out))
+
+/**
+ * Variants of the row-update kernel.
+ *  KERNEL_BASELINE updates every row through the row pointers.
+ *  KERNEL_RESTRICT hoists the row pointers and skips rows whose multiplier is zero.
+ */
+enum Kernel {
+    KERNEL_BASELINE = 0,
+    KERNEL_RESTRICT,
+    KERNEL_COUNT
+};
+
+/**
+ * Phases of an iteration of the pivot loop. The pricing of the next iteration
+ * is fused with the objective update, so PHASE_PRICING is only the first one.
+ * PHASE_BARRIER is the time waited at the synchronization points.
+ */
+enum Phase {
+    PHASE_RATIO = 0,
+    PHASE_NORMALIZE,
+    PHASE_ELIMINATE,
+    PHASE_OBJECTIVE,
+    PHASE_PRICING,
+    PHASE_BOOKKEEPING,
+    PHASE_BARRIER,
+    PHASE_COUNT
+};
+
+/**
+ * Barriers of the pivot loop, named after the work that precedes them.
+ */
+enum Sync_Point {
+    SYNC_PRICING = 0,
+    SYNC_RATIO,
+    SYNC_PIVOT,
+    SYNC_NORMALIZE,
+    SYNC_OBJECTIVE,
+    SYNC_ITERATION,
+    SYNC_COUNT
+};
+
+/**
+ * Outcome of a solve.
+ */
+enum Simplex_Status {
+    SIMPLEX_OPTIMAL = 0,
+    SIMPLEX_UNBOUNDED,
+    SIMPLEX_ITERATION_LIMIT,
+    SIMPLEX_INFEASIBLE,
+    SIMPLEX_CANCELLED,
+    SIMPLEX_TIME_LIMIT,
+    SIMPLEX_TARGET_REACHED,
+    SIMPLEX_STATUS_COUNT
+};
+
+/**
+ * Statistics of the input file gathered by read_data.
+ */
+struct Input_Stats {
+    int lines = 0;
+    int min_row = 0;
+    int max_row = 0;
+};
+
+const char * kernel_name(int kernel);
+const char * phase_name(int phase);
+const char * sync_name(int sync);
+const char * status_name(int status);
+int kernel_from_name(const string& name);
+
+double ** alocate_matrix(int nL, int nC);
+void delete_matrix(double **tableau, int nL);
+void copy_matrix(double **dst, double **src, int nL, int nC);
+
+struct timespec My_diff(struct timespec start, struct timespec end);
+double elapsed_seconds(struct timespec start, struct timespec end);
+
+/**
+ * Aux function to convert string to double
+ * @param t
+ * @param s
+ * @param f
+ * @return
+ */
+template <class T>
+bool from_string(T& t, const string& s, ios_base& (*f)(ios_base&)) {
+    istringstream iss(s);
+    return !(iss >> f >> t).fail();
+}
+
+/**
+ * Function to convert the string line coefficients to double
+ * @param s
+ * @return
+ */
+template <class T>
+vector<T> string_to_vector(string s) {
+    istringstream iss(s);
+    vector<T> vec;
+    do {
+        string sub;
+        iss >> sub;
+        T numb;
+        if (from_string<T>(numb, sub, dec)) {
+            vec.push_back(numb);
+        }
+    } while (iss);
+    return vec;
+}
+
+void get_dimension(char** argv, int &nL, int &nC);
+double ** read_data(char** argv, int& nL, int& nC, Input_Stats *stats = 0);
+double ** generate_problem(int constraints, int variables, double density, unsigned seed, int& nL, int& nC);
+
+void pricing_argmax(double **tableau, int constraintNumb, int colNumb, int chunk, Compare_Max &max,
+                    const char *fixed = 0);
+void ratio_test_argmin(double **tableau, int constraintNumb, int colNumb, int col, int chunk, double tolerance,
+                       Compare_Min &min, int &count);
+void normalize_pivot_row(double **tableau, int colNumb, int row, double pivot);
+void eliminate_rows(double **tableau, int constraintNumb, int colNumb, int row, int col, int kernel, int &updated);
+void update_objective(double **tableau, int constraintNumb, int colNumb, int row, double pivot3, int chunk, Compare_Max &max, int &conta,
+                      const char *fixed = 0);
+void pivot_tableau(double **tableau, int constraintNumb, int colNumb, int row, int col, int kernel);
+bool refactor_basis(double **tableau, double **original, int constraintNumb, int colNumb, int *basis, int kernel);
+double objective_bound(double **tableau, double **original, int constraintNumb, int colNumb);
+void reprice_objective(double **tableau, int constraintNumb, int colNumb, const double *costs, const int *basis);
+bool slack_basis_feasible(double **tableau, int constraintNumb, int colNumb);
+
+/**
+ * Time profile of thread 0 and work counters of a solve, for the roofline report.
+ */
+struct Solve_Profile {
+    int threads = 0;
+    int iterations = 0;
+    bool searched = true;       // pricing and ratio test were executed
+    double phase[PHASE_COUNT] = {};
+    double wait[SYNC_COUNT] = {};
+    long rows_updated = 0;      // rows changed by the row update kernel
+    long ratio_rows = 0;        // rows with a positive entry in the ratio test
+};
+
+/**
+ * State of the pivot loop after an iteration, given to the progress callback.
+ */
+struct Simplex_Progress {
+    int iteration = 0;          // iterations done
+    double objective = 0;       // objective of the current basis
+    double elapsed = 0;         // seconds since the start of the loop
+    double iteration_time = 0;  // seconds of the last iteration
+};
+
+/**
+ * Options of the pivot loop.
+ *  record, when set, receives the (entering, leaving) pair of every iteration.
+ *  replay, when set, forces the pivots of a recorded sequence; with
+ *  replay_skip_search the pricing and the ratio test are not executed, and
+ *  otherwise the iterations where they disagree with the sequence are counted
+ *  in divergences. A recorded pivot whose element is zero in the tableau ends
+ *  the replay, with SIMPLEX_ITERATION_LIMIT.
+ *  telemetry, when it has iteration records enabled, receives one record per
+ *  iteration with the phase times.
+ *  trace, when enabled, receives the begin and end of every phase and barrier
+ *  wait of the sampled iterations, for every thread.
+ *  sync_stats, when set, accounts the wait, arrival skew and load imbalance of
+ *  every barrier.
+ *  profile, when set, receives the phase times and the work counters.
+ *  pivot_tolerance is the smallest coefficient accepted as a pivot by the
+ *  ratio test.
+ *  health, when enabled, runs the sampled numerical checks and may raise the
+ *  pivot tolerance or rebuild the tableau between two iterations. A rebuilt
+ *  tableau may have its rows permuted, so it is not meant for replays.
+ *  threads is the size of the team, 0 for the omp_set_num_threads one.
+ *  max_iterations stops the loop after that many iterations, 0 for no limit.
+ *  time_limit stops it after that many seconds, 0 for no limit, and target
+ *  once the objective reaches that value; both are checked after every
+ *  iteration, so the basis they stop at is primal feasible.
+ *  basis, when set, holds the basic variable of every row (the slack
+ *  variables of the input layout at the start) and follows every pivot.
+ *  status, when set, receives how the loop ended.
+ *  flight, when enabled, keeps the last iterations and is dumped on
+ *  unboundedness and on failed health checks.
+ *  metrics, when set, receives the progress of the solve for the live
+ *  metrics endpoint.
+ *  team_size, when set, is the live size of the team: it is read at every
+ *  iteration boundary and a change ends the parallel region, the loop goes on
+ *  in a new one of the new size. It is ignored with sync_stats, whose
+ *  accounting is per thread of a single team.
+ *  placement, when set, is a generation count of where the team runs: a
+ *  change ends the parallel region like one of team_size, so on_segment runs
+ *  again; it is ignored with sync_stats too.
+ *  on_segment, when set, is called by every thread with its number at the
+ *  start of every parallel region, e.g. to pin it.
+ *  on_progress, when set, is called by one thread after every iteration,
+ *  before the barrier that ends it; returning true stops the loop there.
+ *  cancel, when set, is read at the same point and stops the loop when true.
+ *  fixed, when set, marks the columns that may not enter the basis, one value
+ *  per column: the slacks of the = rows, which are fixed at zero.
+ *  A stopped loop leaves the tableau at the basis of its last iteration, which
+ *  is primal feasible, with status SIMPLEX_CANCELLED.
+ */
+struct Simplex_Options {
+    int chunk = 1;
+    int kernel = KERNEL_BASELINE;
+    vector<Pivot> *record = 0;
+    const vector<Pivot> *replay = 0;
+    bool replay_skip_search = false;
+    int *divergences = 0;
+    Telemetry *telemetry = 0;
+    Trace_Recorder *trace = 0;
+    Sync_Stats *sync_stats = 0;
+    Solve_Profile *profile = 0;
+    double pivot_tolerance = 0.0;
+    Health_Monitor *health = 0;
+    Flight_Recorder *flight = 0;
+    Metrics_Exporter *metrics = 0;
+    int threads = 0;
+    int max_iterations = 0;
+    double time_limit = 0;
+    double target = HUGE_VAL;
+    int *basis = 0;
+    Simplex_Status *status = 0;
+    const atomic<int> *team_size = 0;
+    const atomic<int> *placement = 0;
+    function<void(int)> on_segment;
+    function<bool(const Simplex_Progress&)> on_progress;
+    const atomic<bool> *cancel = 0;
+    const char *fixed = 0;
+};
+
+int simplex(double **tableau, int constraintNumb, int colNumb, const Simplex_Options& opt);
+int dual_simplex(double **tableau, int constraintNumb, int colNumb, const Simplex_Options& opt);
+int phase_one(double **tableau, int constraintNumb, int colNumb, const Simplex_Options& opt, char *fixed);
+int crash_basis(double **tableau, int constraintNumb, int colNumb, const Simplex_Options& opt);
+
+#endif
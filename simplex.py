@@ -0,0 +1,184 @@
+# ----------------------------------------------------------------------------
+# @file  simplex.py
+# @author Demétrios A. M. Coutinho
+# @email demetrios.coutinho@ifrn.edu.br
+# @author Samuel Xavier de Souza
+# @email samuel@dca.ufrn.edu.br
+# @date    08/2017
+#
+# @brief ctypes binding of the C interface of the solver (simplex_c.h).
+# @language: Python
+#
+# @section Description
+#  NumPy arrays are handed to the library as pointers. A C-contiguous float64
+#  tableau in the layout of the input files is solved in place without any
+#  copy (Problem.wrap); A, b and c are copied once by the library
+#  (Problem.dense). The library is libsimplex.so next to this file, or the
+#  path in SIMPLEX_LIBRARY.
+#
+#  progress(iteration, objective, elapsed) is called after every iteration
+#  and stops the solve when it returns True; Solver.cancel does the same from
+#  another thread. A stopped solve returns status "cancelled" and the current
+#  feasible solution; time_limit and target stop it in the same way, with
+#  status "time limit" or "target reached". The bound of a result is an upper
+#  bound of the optimal objective (inf when unknown) and gap its distance to
+#  the objective; a result without a feasible basis has an empty basis and
+#  zero x and duals. With crash=True a solve starts from a triangular crash
+#  basis, with structural columns in place of slacks.
+#
+#  Example:
+#
+#    import numpy as np, simplex
+#    p = simplex.Problem.dense(A, b, c)
+#    r = simplex.Solver(threads=8).solve(p)
+#    if r.status == "optimal": print(r.objective, r.x)
+# ----------------------------------------------------------------------------
+
+import ctypes
+import os
+from collections import namedtuple
+
+import numpy as np
+
+_path = os.environ.get("SIMPLEX_LIBRARY", os.path.join(os.path.dirname(os.path.abspath(__file__)), "libsimplex.so"))
+_lib = ctypes.CDLL(_path)
+
+_p = ctypes.c_void_p
+_doubles = np.ctypeslib.ndpointer(dtype=np.float64, flags="C_CONTIGUOUS")
+_ints = np.ctypeslib.ndpointer(dtype=np.intc, flags="C_CONTIGUOUS")
+_progress = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_int, ctypes.c_double, ctypes.c_double, ctypes.c_void_p)
+
+for name, restype, argtypes in [
+        ("simplex_abi_version", ctypes.c_int, []),
+        ("simplex_status_name", ctypes.c_char_p, [ctypes.c_int]),
+        ("simplex_problem_wrap", _p, [_doubles, ctypes.c_int, ctypes.c_int, ctypes.c_size_t]),
+        ("simplex_problem_dense", _p, [ctypes.c_int, ctypes.c_int, _doubles, _doubles, _doubles]),
+        ("simplex_problem_load", _p, [ctypes.c_char_p]),
+        ("simplex_problem_constraints", ctypes.c_int, [_p]),
+        ("simplex_problem_variables", ctypes.c_int, [_p]),
+        ("simplex_problem_free", None, [_p]),
+        ("simplex_solver_create", _p, []),
+        ("simplex_solver_set_threads", None, [_p, ctypes.c_int]),
+        ("simplex_solver_set_chunk", None, [_p, ctypes.c_int]),
+        ("simplex_solver_set_kernel", ctypes.c_int, [_p, ctypes.c_char_p]),
+        ("simplex_solver_set_max_iterations", None, [_p, ctypes.c_int]),
+        ("simplex_solver_set_time_limit", None, [_p, ctypes.c_double]),
+        ("simplex_solver_set_target", None, [_p, ctypes.c_double]),
+        ("simplex_solver_set_crash", None, [_p, ctypes.c_int]),
+        ("simplex_solver_set_progress", None, [_p, _progress, _p]),
+        ("simplex_solver_cancel", None, [_p]),
+        ("simplex_solver_free", None, [_p]),
+        ("simplex_solve", _p, [_p, _p, ctypes.c_int]),
+        ("simplex_result_status", ctypes.c_int, [_p]),
+        ("simplex_result_iterations", ctypes.c_int, [_p]),
+        ("simplex_result_objective", ctypes.c_double, [_p]),
+        ("simplex_result_time", ctypes.c_double, [_p]),
+        ("simplex_result_bound", ctypes.c_double, [_p]),
+        ("simplex_result_x", ctypes.c_int, [_p, _doubles, ctypes.c_int]),
+        ("simplex_result_duals", ctypes.c_int, [_p, _doubles, ctypes.c_int]),
+        ("simplex_result_basis", ctypes.c_int, [_p, _ints, ctypes.c_int]),
+        ("simplex_result_free", None, [_p])]:
+    function = getattr(_lib, name)
+    function.restype = restype
+    function.argtypes = argtypes
+
+if _lib.simplex_abi_version() < 4:
+    raise ImportError("%s is older than this binding" % _path)
+
+Result = namedtuple("Result", "status iterations objective time x duals basis bound gap")
+
+
+class Problem(object):
+    """Problem handle; keeps the wrapped array alive while it is in use."""
+
+    def __init__(self, handle, buffer=None):
+        if not handle:
+            raise ValueError("invalid problem")
+        self._handle = handle
+        self._buffer = buffer
+
+    @classmethod
+    def wrap(cls, tableau):
+        """Solve a (m + 1) x (m + n + 1) float64 C-contiguous tableau without copying it."""
+        if tableau.dtype != np.float64 or not tableau.flags.c_contiguous or tableau.ndim != 2:
+            raise ValueError("the tableau must be a 2-D C-contiguous float64 array")
+        m = tableau.shape[0] - 1
+        n = tableau.shape[1] - m - 1
+        return cls(_lib.simplex_problem_wrap(tableau, m, n, tableau.shape[1]), tableau)
+
+    @classmethod
+    def dense(cls, A, b, c):
+        """Copy A, b and c into a tableau owned by the library."""
+        A = np.ascontiguousarray(A, dtype=np.float64)
+        b = np.ascontiguousarray(b, dtype=np.float64)
+        c = np.ascontiguousarray(c, dtype=np.float64)
+        m, n = A.shape
+        if b.shape != (m,) or c.shape != (n,):
+            raise ValueError("b needs one value per row of A and c one per column")
+        return cls(_lib.simplex_problem_dense(m, n, A, b, c))
+
+    @classmethod
+    def load(cls, path):
+        return cls(_lib.simplex_problem_load(path.encode()))
+
+    @property
+    def constraints(self):
+        return _lib.simplex_problem_constraints(self._handle)
+
+    @property
+    def variables(self):
+        return _lib.simplex_problem_variables(self._handle)
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.simplex_problem_free(self._handle)
+            self._handle = None
+
+
+class Solver(object):
+    def __init__(self, threads=0, chunk=1, kernel=None, max_iterations=0, time_limit=0, target=None,
+                 progress=None, crash=False):
+        self._handle = _lib.simplex_solver_create()
+        if not self._handle:
+            raise MemoryError()
+        _lib.simplex_solver_set_threads(self._handle, threads)
+        _lib.simplex_solver_set_chunk(self._handle, chunk)
+        _lib.simplex_solver_set_max_iterations(self._handle, max_iterations)
+        _lib.simplex_solver_set_time_limit(self._handle, time_limit)
+        if target is not None:
+            _lib.simplex_solver_set_target(self._handle, target)
+        _lib.simplex_solver_set_crash(self._handle, int(crash))
+        if kernel and _lib.simplex_solver_set_kernel(self._handle, kernel.encode()):
+            raise ValueError("unknown kernel %s" % kernel)
+        self._progress = None
+        if progress:
+            self._progress = _progress(lambda i, objective, elapsed, data: int(bool(progress(i, objective, elapsed))))
+            _lib.simplex_solver_set_progress(self._handle, self._progress, None)
+
+    def cancel(self):
+        """Stop the running solve at its next iteration, from any thread."""
+        _lib.simplex_solver_cancel(self._handle)
+
+    def solve(self, problem, in_place=False):
+        """Solve a problem; in place, a wrapped array holds the final tableau afterwards."""
+        r = _lib.simplex_solve(self._handle, problem._handle, int(in_place))
+        if not r:
+            raise RuntimeError("solve failed")
+        try:
+            n, m = problem.variables, problem.constraints
+            x, duals, basis = np.empty(n), np.empty(m), np.empty(m, dtype=np.intc)
+            # Only what the library filled: an infeasible result has no basis.
+            x = x[:_lib.simplex_result_x(r, x, n)]
+            duals = duals[:_lib.simplex_result_duals(r, duals, m)]
+            basis = basis[:_lib.simplex_result_basis(r, basis, m)]
+            objective, bound = _lib.simplex_result_objective(r), _lib.simplex_result_bound(r)
+            return Result(_lib.simplex_status_name(_lib.simplex_result_status(r)).decode(),
+                          _lib.simplex_result_iterations(r), objective, _lib.simplex_result_time(r),
+                          x, duals, basis, bound, bound - objective)
+        finally:
+            _lib.simplex_result_free(r)
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.simplex_solver_free(self._handle)
+            self._handle = None
@@ -0,0 +1,229 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  simplex_c.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief C interface of the solver library.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <new>
+
+#include "simplex_c.h"
+#include "solver.h"
+
+struct simplex_problem {
+    Problem problem;
+};
+
+struct simplex_solver {
+    Solver solver;
+};
+
+struct simplex_result {
+    Result result;
+};
+
+static_assert(SIMPLEX_STATUS_OPTIMAL == SIMPLEX_OPTIMAL && SIMPLEX_STATUS_UNBOUNDED == SIMPLEX_UNBOUNDED &&
+              SIMPLEX_STATUS_ITERATION_LIMIT == SIMPLEX_ITERATION_LIMIT && SIMPLEX_STATUS_INFEASIBLE == SIMPLEX_INFEASIBLE &&
+              SIMPLEX_STATUS_CANCELLED == SIMPLEX_CANCELLED && SIMPLEX_STATUS_TIME_LIMIT == SIMPLEX_TIME_LIMIT &&
+              SIMPLEX_STATUS_TARGET_REACHED == SIMPLEX_TARGET_REACHED,
+              "C status codes out of date");
+
+/**
+ * Copy the first values of a vector to a caller's array.
+ * @param v
+ * @param out may be null, to query the size
+ * @param size capacity of out
+ * @return the size of the vector
+ */
+template <class T>
+static int copy_out(const vector<T>& v, T *out, int size) {
+    if (out)
+        for (int k = 0; k < size && k < (int) v.size(); k++) out[k] = v[k];
+    return v.size();
+}
+
+extern "C" {
+
+int simplex_abi_version(void) {
+    return SIMPLEX_ABI_VERSION;
+}
+
+const char *simplex_status_name(int status) {
+    return status_name(status);
+}
+
+simplex_problem *simplex_problem_create(int constraints, int variables) {
+    if (constraints <= 0 || variables <= 0) return 0;
+    simplex_problem *p = new (nothrow) simplex_problem;
+    if (!p) return 0;
+    try {
+        p->problem = Problem(constraints, variables);
+    } catch (...) {
+        delete p;
+        return 0;
+    }
+    return p;
+}
+
+simplex_problem *simplex_problem_wrap(double *tableau, int constraints, int variables, size_t stride) {
+    if (!tableau || constraints <= 0 || variables <= 0 || stride < (size_t) constraints + variables + 1) return 0;
+    simplex_problem *p = new (nothrow) simplex_problem;
+    if (!p) return 0;
+    try {
+        p->problem.wrap(tableau, constraints, variables, stride);
+    } catch (...) {
+        delete p;
+        return 0;
+    }
+    return p;
+}
+
+simplex_problem *simplex_problem_dense(int constraints, int variables, const double *A, const double *b,
+                                       const double *c) {
+    if (!A || !b || !c || constraints <= 0 || variables <= 0) return 0;
+    simplex_problem *p = new (nothrow) simplex_problem;
+    if (!p) return 0;
+    try {
+        p->problem = Problem(constraints, variables, A, b, c);
+    } catch (...) {
+        delete p;
+        return 0;
+    }
+    return p;
+}
+
+simplex_problem *simplex_problem_load(const char *path) {
+    if (!path) return 0;
+    simplex_problem *p = new (nothrow) simplex_problem;
+    if (!p) return 0;
+    try {
+        if (p->problem.load(path)) return p;
+    } catch (...) {
+    }
+    delete p;
+    return 0;
+}
+
+int simplex_problem_constraints(const simplex_problem *problem) {
+    return problem ? problem->problem.constraints() : 0;
+}
+
+int simplex_problem_variables(const simplex_problem *problem) {
+    return problem ? problem->problem.variables() : 0;
+}
+
+void simplex_problem_free(simplex_problem *problem) {
+    delete problem;
+}
+
+simplex_solver *simplex_solver_create(void) {
+    return new (nothrow) simplex_solver;
+}
+
+void simplex_solver_set_threads(simplex_solver *solver, int threads) {
+    if (solver) solver->solver.set_threads(threads);
+}
+
+void simplex_solver_set_chunk(simplex_solver *solver, int chunk) {
+    if (solver && chunk > 0) solver->solver.set_chunk(chunk);
+}
+
+int simplex_solver_set_kernel(simplex_solver *solver, const char *name) {
+    int kernel = name ? kernel_from_name(name) : -1;
+    if (!solver || kernel < 0) return -1;
+    solver->solver.set_kernel(kernel);
+    return 0;
+}
+
+void simplex_solver_set_max_iterations(simplex_solver *solver, int iterations) {
+    if (solver) solver->solver.set_max_iterations(iterations);
+}
+
+void simplex_solver_set_time_limit(simplex_solver *solver, double seconds) {
+    if (solver) solver->solver.set_time_limit(seconds);
+}
+
+void simplex_solver_set_target(simplex_solver *solver, double objective) {
+    if (solver) solver->solver.set_target(objective);
+}
+
+void simplex_solver_set_crash(simplex_solver *solver, int enabled) {
+    if (solver) solver->solver.set_crash(enabled != 0);
+}
+
+void simplex_solver_set_progress(simplex_solver *solver, simplex_progress_fn progress, void *data) {
+    if (!solver) return;
+    if (!progress) {
+        solver->solver.set_progress(function<bool(const Simplex_Progress&)>());
+        return;
+    }
+    solver->solver.set_progress([progress, data](const Simplex_Progress& p) {
+        return progress(p.iteration, p.objective, p.elapsed, data) != 0;
+    });
+}
+
+void simplex_solver_cancel(simplex_solver *solver) {
+    if (solver) solver->solver.cancel();
+}
+
+void simplex_solver_free(simplex_solver *solver) {
+    delete solver;
+}
+
+simplex_result *simplex_solve(simplex_solver *solver, simplex_problem *problem, int in_place) {
+    if (!solver || !problem || problem->problem.empty()) return 0;
+    simplex_result *r = new (nothrow) simplex_result;
+    if (!r) return 0;
+    try {
+        r->result = in_place ? solver->solver.solve_in_place(problem->problem) : solver->solver.solve(problem->problem);
+        return r;
+    } catch (...) {
+        delete r;
+        return 0;
+    }
+}
+
+int simplex_result_status(const simplex_result *result) {
+    return result ? result->result.status : -1;
+}
+
+int simplex_result_iterations(const simplex_result *result) {
+    return result ? result->result.iterations : 0;
+}
+
+double simplex_result_objective(const simplex_result *result) {
+    return result ? result->result.objective : 0.0;
+}
+
+double simplex_result_time(const simplex_result *result) {
+    return result ? result->result.time : 0.0;
+}
+
+double simplex_result_bound(const simplex_result *result) {
+    return result ? result->result.bound : 0.0;
+}
+
+int simplex_result_x(const simplex_result *result, double *x, int size) {
+    return result ? copy_out(result->result.x, x, size) : 0;
+}
+
+int simplex_result_duals(const simplex_result *result, double *duals, int size) {
+    return result ? copy_out(result->result.duals, duals, size) : 0;
+}
+
+int simplex_result_basis(const simplex_result *result, int *basis, int size) {
+    return result ? copy_out(result->result.basis, basis, size) : 0;
+}
+
+void simplex_result_free(simplex_result *result) {
+    delete result;
+}
+
+}
@@ -0,0 +1,121 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  simplex_c.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief C interface of the solver library, for callers in other languages.
+ * @language: C
+ *
+ * @section Description
+ *  Opaque handles over Problem, Solver and Result (solver.h). Every function
+ *  is safe to call with a null handle and never throws nor exits; creation
+ *  functions return null on failure. The interface only grows: functions are
+ *  never removed nor change signature, and simplex_abi_version is bumped when
+ *  some are added.
+ *
+ *  Problems can be given without a copy: simplex_problem_wrap solves the
+ *  caller's contiguous tableau in place, row i starting at tableau + i * stride,
+ *  in the layout of the input files:
+ *
+ *  | A  I  b|
+ *  |-c  0  0|
+ *
+ *  where -1 or 0 on the diagonal of I makes the row a >= or an = one.
+ *  simplex_problem_dense copies row-major A, b and c once, in parallel.
+ *
+ *  simplex_solver_cancel may be called from another thread while
+ *  simplex_solve runs; the solve returns at its next iteration with
+ *  SIMPLEX_STATUS_CANCELLED and the current feasible solution. The time and
+ *  objective limits stop it in the same way; simplex_result_bound is then an
+ *  upper bound of the optimal objective, HUGE_VAL when none is known.
+ *
+ *  Example:
+ *
+ *    simplex_problem *p = simplex_problem_dense(m, n, A, b, c);
+ *    simplex_solver *s = simplex_solver_create();
+ *    simplex_solver_set_threads(s, 8);
+ *    simplex_result *r = simplex_solve(s, p, 0);
+ *    if (simplex_result_status(r) == SIMPLEX_STATUS_OPTIMAL)
+ *        simplex_result_x(r, x, n);
+ *    simplex_result_free(r);
+ *    simplex_solver_free(s);
+ *    simplex_problem_free(p);
+ *
+ * @subsection Compilation
+ *   The shared library is built with:
+ *
+ *  g++ -Ofast -fPIC -shared simplex_c.cpp solver.cpp result_cache.cpp simplex.cpp pivot_trace.cpp telemetry.cpp trace_events.cpp sync_stats.cpp roofline.cpp health.cpp flight_recorder.cpp metrics.cpp energy.cpp reference.cpp -fopenmp -Wall -o libsimplex.so
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef SIMPLEX_C_H
+#define SIMPLEX_C_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIMPLEX_ABI_VERSION 4
+
+/* Values of simplex_result_status, the same as Simplex_Status. */
+#define SIMPLEX_STATUS_OPTIMAL          0
+#define SIMPLEX_STATUS_UNBOUNDED        1
+#define SIMPLEX_STATUS_ITERATION_LIMIT  2
+#define SIMPLEX_STATUS_INFEASIBLE       3
+#define SIMPLEX_STATUS_CANCELLED        4
+#define SIMPLEX_STATUS_TIME_LIMIT       5
+#define SIMPLEX_STATUS_TARGET_REACHED   6
+
+/* Called after every iteration; a nonzero return stops the solve. */
+typedef int (*simplex_progress_fn)(int iteration, double objective, double elapsed, void *data);
+
+typedef struct simplex_problem simplex_problem;
+typedef struct simplex_solver simplex_solver;
+typedef struct simplex_result simplex_result;
+
+int simplex_abi_version(void);
+const char *simplex_status_name(int status);
+
+simplex_problem *simplex_problem_create(int constraints, int variables);
+simplex_problem *simplex_problem_wrap(double *tableau, int constraints, int variables, size_t stride);
+simplex_problem *simplex_problem_dense(int constraints, int variables, const double *A, const double *b,
+                                       const double *c);
+simplex_problem *simplex_problem_load(const char *path);
+int simplex_problem_constraints(const simplex_problem *problem);
+int simplex_problem_variables(const simplex_problem *problem);
+void simplex_problem_free(simplex_problem *problem);
+
+simplex_solver *simplex_solver_create(void);
+void simplex_solver_set_threads(simplex_solver *solver, int threads);
+void simplex_solver_set_chunk(simplex_solver *solver, int chunk);
+int simplex_solver_set_kernel(simplex_solver *solver, const char *name);
+void simplex_solver_set_max_iterations(simplex_solver *solver, int iterations);
+void simplex_solver_set_time_limit(simplex_solver *solver, double seconds);
+void simplex_solver_set_target(simplex_solver *solver, double objective);
+void simplex_solver_set_crash(simplex_solver *solver, int enabled);
+void simplex_solver_set_progress(simplex_solver *solver, simplex_progress_fn progress, void *data);
+void simplex_solver_cancel(simplex_solver *solver);
+void simplex_solver_free(simplex_solver *solver);
+
+simplex_result *simplex_solve(simplex_solver *solver, simplex_problem *problem, int in_place);
+int simplex_result_status(const simplex_result *result);
+int simplex_result_iterations(const simplex_result *result);
+double simplex_result_objective(const simplex_result *result);
+double simplex_result_time(const simplex_result *result);
+double simplex_result_bound(const simplex_result *result);
+int simplex_result_x(const simplex_result *result, double *x, int size);
+int simplex_result_duals(const simplex_result *result, double *duals, int size);
+int simplex_result_basis(const simplex_result *result, int *basis, int size);
+void simplex_result_free(simplex_result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
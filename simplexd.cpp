@@ -0,0 +1,511 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  simplexd.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Solver daemon: problems are sent over a Unix socket and solved by a
+ *  long-lived OpenMP team, without a process start per solve.
+ * @language: C++
+ *
+ * @section Description
+ *  One solver thread owns the OpenMP team, which is created (and optionally
+ *  pinned, one thread per CPU) at startup and reused by every solve, so the
+ *  solves are queued and run one at a time at full width. Every connection has
+ *  its own thread that reads the requests into tableau buffers taken from a
+ *  size-class pool, hands them to the solver thread and streams the results
+ *  back. A connection may send any number of requests. With a result cache,
+ *  repeated problems are answered without solving and problems of a known
+ *  shape are warm started (result_cache.h).
+ *
+ *  On SIGINT or SIGTERM the daemon stops accepting, shuts the open
+ *  connections down, refuses new solves, answers the queued ones and joins
+ *  every thread before it exits.
+ *
+ * @subsection Protocol
+ *   Request: a header line followed by the tableau, in the layout of the input
+ *   files ((m + 1) rows of m + n + 1 values):
+ *
+ *     solve <m> <n> binary|text [threads=t] [chunk=c] [max_iterations=k] [time_limit=s] [target=z]
+ *
+ *   binary: (m + 1) * (m + n + 1) doubles in host byte order, row by row.
+ *   text:   m + 1 lines of whitespace separated values, as in the input files.
+ *
+ *   Response, one line each:
+ *
+ *     status <name> iterations <k> objective <z> time <seconds> bound <b> [cached|warm]
+ *     x <n values>
+ *     duals <m values>
+ *     basis <m indices>
+ *     end
+ *
+ *   bound is an upper bound of the optimal objective (inf when unknown), the
+ *   objective itself when optimal.
+ *
+ *   or "error <message>". The request "stats" answers with the pool and cache counters.
+ *
+ * @subsection Compilation
+ *   To compile this file you need to run the following command:
+ *
+ *  g++ -Ofast simplexd.cpp buffer_pool.cpp solver.cpp result_cache.cpp simplex.cpp pivot_trace.cpp telemetry.cpp trace_events.cpp sync_stats.cpp roofline.cpp health.cpp flight_recorder.cpp metrics.cpp energy.cpp reference.cpp -fopenmp -Wall -o simplexd
+ *
+ * @subsection usage
+ *   ./simplexd --socket /PATH [options]
+ *
+ *   --threads n          size of the OpenMP team (default every CPU)
+ *   --chunk c            default chunk of the solves (default 1)
+ *   --pin                pin the team, thread i on the i-th CPU of the process affinity mask
+ *   --pool-mib n         limit of the pooled buffers (default 1024)
+ *   --cache-mib n        keep up to n MiB of results in memory (default 0, no cache)
+ *   --cache-dir dir      keep the results in dir as well
+ *   --cache-dir-mib n    size limit of the cache directory (default 1024)
+ *   <kernel>             row-update kernel of the solves
+ *
+ *   Example with the text format:
+ *
+ *   (echo "solve 200 150 text"; cat 200x150) | socat - UNIX-CONNECT:/tmp/simplexd.sock
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <iostream>
+#include <deque>
+#include <list>
+#include <atomic>
+#include <future>
+#include <condition_variable>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "solver.h"
+#include "buffer_pool.h"
+#include "result_cache.h"
+
+static volatile sig_atomic_t stopping = 0;
+
+static void on_signal(int) {
+    stopping = 1;
+}
+
+/**
+ * Solve request queued for the solver thread.
+ */
+struct Job {
+    Problem problem;
+    int threads = 0;
+    int chunk = 0;
+    int max_iterations = 0;
+    double time_limit = 0;
+    double target = HUGE_VAL;
+    promise<Result> done;
+};
+
+/**
+ * Queue of the solver thread.
+ */
+struct Job_Queue {
+    mutex lock;
+    condition_variable ready;
+    deque<Job *> jobs;
+    bool closed = false;
+
+    // false, without queueing, once the queue is closed
+    bool push(Job *job) {
+        lock_guard<mutex> guard(lock);
+        if (closed) return false;
+        jobs.push_back(job);
+        ready.notify_one();
+        return true;
+    }
+
+    Job * pop() {
+        unique_lock<mutex> guard(lock);
+        ready.wait(guard, [this] { return closed || !jobs.empty(); });
+        if (jobs.empty()) return 0;
+        Job *job = jobs.front();
+        jobs.pop_front();
+        return job;
+    }
+
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        ready.notify_all();
+    }
+};
+
+/**
+ * Buffered reads and writes on a connection.
+ */
+struct Connection {
+    int fd;
+    string pending;
+
+    bool fill() {
+        char chunk[1 << 16];
+        ssize_t n = recv(fd, chunk, sizeof (chunk), 0);
+        if (n <= 0) return false;
+        pending.append(chunk, n);
+        return true;
+    }
+
+    bool read_line(string& line) {
+        size_t end;
+        while ((end = pending.find('\n')) == string::npos)
+            if (!fill()) return false;
+        line.assign(pending, 0, end);
+        pending.erase(0, end + 1);
+        if (line.size() && line[line.size() - 1] == '\r') line.resize(line.size() - 1);
+        return true;
+    }
+
+    bool read_exact(char *out, size_t bytes) {
+        size_t done = min(bytes, pending.size());
+        memcpy(out, pending.data(), done);
+        pending.erase(0, done);
+        while (done < bytes) {
+            ssize_t n = recv(fd, out + done, bytes - done, 0);
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+    bool write(const string& s) {
+        size_t done = 0;
+        while (done < s.size()) {
+            ssize_t n = send(fd, s.data() + done, s.size() - done, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+};
+
+/**
+ * Connection and its thread. The socket is closed by the main thread once
+ * the connection thread is joined.
+ */
+struct Client {
+    int fd;
+    thread worker;
+    atomic<bool> finished{false};
+};
+
+/**
+ * Daemon state shared by the connection threads.
+ */
+struct Daemon {
+    Job_Queue queue;
+    Buffer_Pool pool;
+    Result_Cache *cache = 0;
+    int team = 1;
+    int chunk = 1;
+    int kernel = KERNEL_BASELINE;
+    bool pin = false;
+
+    explicit Daemon(size_t pool_bytes) : pool(pool_bytes) {}
+};
+
+/**
+ * Create the OpenMP team of the calling thread, pinning thread i to the i-th
+ * CPU of the process affinity mask. Later parallel regions of this thread
+ * reuse the same team.
+ * @param team
+ * @param pin
+ */
+static void warm_team(int team, bool pin) {
+    vector<int> cpus;
+    cpu_set_t mask;
+
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof (mask), &mask) == 0)
+        for (int c = 0; c < CPU_SETSIZE; c++)
+            if (CPU_ISSET(c, &mask)) cpus.push_back(c);
+    if (cpus.empty())
+        for (int c = 0; c < sysconf(_SC_NPROCESSORS_ONLN); c++) cpus.push_back(c);
+
+#pragma omp parallel num_threads(team) default(none) shared(cpus, pin)
+    if (pin) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[omp_get_thread_num() % cpus.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof (set), &set);
+    }
+}
+
+/**
+ * Solver thread: owns the team and runs the queued solves one at a time.
+ * @param daemon
+ */
+static void solve_loop(Daemon *daemon) {
+    Solver solver;
+    Job *job;
+
+    warm_team(daemon->team, daemon->pin);
+    solver.set_kernel(daemon->kernel);
+    solver.set_cache(daemon->cache);
+
+    while ((job = daemon->queue.pop()) != 0) {
+        solver.set_threads(job->threads > 0 ? min(job->threads, daemon->team) : daemon->team);
+        solver.set_chunk(job->chunk > 0 ? job->chunk : daemon->chunk);
+        solver.set_max_iterations(job->max_iterations);
+        solver.set_time_limit(job->time_limit);
+        solver.set_target(job->target);
+        // The cache needs the problem untouched for the warm start.
+        job->done.set_value(daemon->cache ? solver.solve(job->problem) : solver.solve_in_place(job->problem));
+    }
+}
+
+/**
+ * Read the text payload: m + 1 lines of at most 'width' values, the missing
+ * ones are zero.
+ * @param conn
+ * @param tableau
+ * @param rows
+ * @param width
+ * @return false when the connection ends first
+ */
+static bool read_text(Connection& conn, double *tableau, int rows, int width) {
+    string line;
+
+    for (int i = 0; i < rows; i++) {
+        if (!conn.read_line(line)) return false;
+        double *row = tableau + (size_t) i * width;
+        const char *p = line.c_str();
+        char *end;
+        int j = 0;
+        for (; j < width; j++) {
+            row[j] = strtod(p, &end);
+            if (end == p) break;
+            p = end;
+        }
+        for (; j < width; j++) row[j] = 0.0;
+    }
+    return true;
+}
+
+/**
+ * Format a result in the response lines.
+ * @param r
+ * @return
+ */
+static string format_result(const Result& r) {
+    char head[256];
+    string out;
+
+    snprintf(head, sizeof (head), "status %s iterations %d objective %.17g time %.9f bound %.17g%s\n",
+             status_name(r.status), r.iterations, r.objective, r.time, r.bound,
+             r.cached ? " cached" : r.warm_start ? " warm" : "");
+    out = head;
+    out += "x";
+    for (size_t j = 0; j < r.x.size(); j++) {
+        snprintf(head, sizeof (head), " %.17g", r.x[j]);
+        out += head;
+    }
+    out += "\nduals";
+    for (size_t i = 0; i < r.duals.size(); i++) {
+        snprintf(head, sizeof (head), " %.17g", r.duals[i]);
+        out += head;
+    }
+    out += "\nbasis";
+    for (size_t i = 0; i < r.basis.size(); i++) out += " " + to_string(r.basis[i]);
+    out += "\nend\n";
+    return out;
+}
+
+/**
+ * Connection thread: read the requests, queue the solves, write the results.
+ * @param daemon
+ * @param client
+ */
+static void serve_connection(Daemon *daemon, Client *client) {
+    Connection conn = {client->fd, ""};
+    string line;
+
+    while (conn.read_line(line)) {
+        if (line.empty()) continue;
+        if (line == "stats") {
+            string stats = daemon->pool.report() + "\n";
+            if (daemon->cache) stats += daemon->cache->report() + "\n";
+            if (!conn.write(stats)) break;
+            continue;
+        }
+
+        stringstream ss(line);
+        string verb, format, option;
+        Job job;
+        int m = 0, n = 0;
+        ss >> verb >> m >> n >> format;
+        while (ss >> option) {
+            if (!option.compare(0, 8, "threads=")) job.threads = atoi(option.c_str() + 8);
+            else if (!option.compare(0, 6, "chunk=")) job.chunk = atoi(option.c_str() + 6);
+            else if (!option.compare(0, 15, "max_iterations=")) job.max_iterations = atoi(option.c_str() + 15);
+            else if (!option.compare(0, 11, "time_limit=")) job.time_limit = atof(option.c_str() + 11);
+            else if (!option.compare(0, 7, "target=")) job.target = atof(option.c_str() + 7);
+        }
+        if (verb != "solve" || m <= 0 || n <= 0 || (format != "binary" && format != "text")) {
+            // The payload can not be skipped without its size.
+            conn.write("error invalid request: " + line + "\n");
+            break;
+        }
+
+        int rows = m + 1, width = m + n + 1;
+        size_t values = (size_t) rows * width;
+        double *buffer = daemon->pool.acquire(values);
+        if (!buffer) {
+            conn.write("error out of memory\n");
+            break;
+        }
+
+        bool read = format == "binary" ? conn.read_exact((char *) buffer, values * sizeof (double))
+                                       : read_text(conn, buffer, rows, width);
+        if (!read) {
+            daemon->pool.release(buffer, values);
+            break;
+        }
+
+        job.problem.wrap(buffer, m, n, width);
+        future<Result> result = job.done.get_future();
+        if (!daemon->queue.push(&job)) {
+            daemon->pool.release(buffer, values);
+            conn.write("error shutting down\n");
+            break;
+        }
+        bool written = conn.write(format_result(result.get()));
+        daemon->pool.release(buffer, values);
+        if (!written) break;
+    }
+    client->finished = true;
+}
+
+/**
+ * Join the connection threads that are done, or all of them, and close their
+ * sockets.
+ * @param clients
+ * @param all
+ */
+static void reap_clients(list<Client *>& clients, bool all) {
+    for (list<Client *>::iterator it = clients.begin(); it != clients.end(); ) {
+        Client *client = *it;
+        if (!all && !client->finished) {
+            ++it;
+            continue;
+        }
+        client->worker.join();
+        close(client->fd);
+        delete client;
+        it = clients.erase(it);
+    }
+}
+
+/**
+ * Main function of the daemon
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char** argv) {
+    string socket_path;
+    int team = omp_get_num_procs(), chunk = 1, kernel = KERNEL_BASELINE, pool_mib = 1024;
+    int cache_mib = 0, cache_dir_mib = 1024;
+    string cache_dir;
+    bool pin = false;
+
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+
+        if (arg == "--pin") pin = true;
+        else if (arg == "--socket" && a + 1 < argc) socket_path = argv[++a];
+        else if (arg == "--threads" && a + 1 < argc) from_string<int>(team, argv[++a], std::dec);
+        else if (arg == "--chunk" && a + 1 < argc) from_string<int>(chunk, argv[++a], std::dec);
+        else if (arg == "--pool-mib" && a + 1 < argc) from_string<int>(pool_mib, argv[++a], std::dec);
+        else if (arg == "--cache-mib" && a + 1 < argc) from_string<int>(cache_mib, argv[++a], std::dec);
+        else if (arg == "--cache-dir" && a + 1 < argc) cache_dir = argv[++a];
+        else if (arg == "--cache-dir-mib" && a + 1 < argc) from_string<int>(cache_dir_mib, argv[++a], std::dec);
+        else if ((kernel = kernel_from_name(arg)) < 0) {
+            cerr << "Unknown argument " << arg << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (socket_path.empty() || team <= 0 || chunk <= 0) {
+        cerr << "Usage: " << argv[0] << " --socket /PATH [--threads n] [--chunk c] [--pin] [--pool-mib n] [kernel]"
+             << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof (addr.sun_path)) {
+        cerr << "Socket path too long " << socket_path << endl;
+        exit(EXIT_FAILURE);
+    }
+    strcpy(addr.sun_path, socket_path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path.c_str());
+    if (fd < 0 || bind(fd, (struct sockaddr *) &addr, sizeof (addr)) || listen(fd, 64)) {
+        perror("socket");
+        exit(EXIT_FAILURE);
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    Daemon daemon((size_t) pool_mib << 20);
+    daemon.team = team;
+    daemon.chunk = chunk;
+    daemon.kernel = kernel;
+    daemon.pin = pin;
+
+    Result_Cache cache((size_t) cache_mib << 20);
+    if (cache_dir.size() && !cache.open_disk(cache_dir, (size_t) cache_dir_mib << 20)) {
+        cerr << "Error opening cache directory " << cache_dir << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (cache_mib > 0 || cache_dir.size()) daemon.cache = &cache;
+
+    thread solver(solve_loop, &daemon);
+
+    cerr << "simplexd: listening on " << socket_path << " with " << team << " threads" << endl;
+
+    list<Client *> clients;
+    while (!stopping) {
+        struct pollfd p = {fd, POLLIN, 0};
+        reap_clients(clients, false);
+        if (poll(&p, 1, 200) <= 0 || !(p.revents & POLLIN)) continue;
+
+        int accepted = accept(fd, 0, 0);
+        if (accepted < 0) continue;
+        Client *client = new Client;
+        client->fd = accepted;
+        client->worker = thread(serve_connection, &daemon, client);
+        clients.push_back(client);
+    }
+
+    close(fd);
+    unlink(socket_path.c_str());
+    // The connection threads use the daemon and the cache: wake those blocked
+    // on their sockets, refuse new solves and let the queued ones finish
+    // before the threads are joined.
+    for (list<Client *>::iterator it = clients.begin(); it != clients.end(); ++it)
+        shutdown((*it)->fd, SHUT_RDWR);
+    daemon.queue.close();
+    reap_clients(clients, true);
+    solver.join();
+    cerr << "simplexd: " << daemon.pool.report() << endl;
+    if (daemon.cache) cerr << "simplexd: " << cache.report() << endl;
+    return 0;
+}
@@ -0,0 +1,326 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  solver.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Library API of the parallel simplex.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+
+#include "solver.h"
+#include "result_cache.h"
+
+/**
+ * Problem with every coefficient, bound and cost at zero and the identity
+ * block of the slack variables.
+ * @param constraints
+ * @param variables
+ */
+Problem::Problem(int constraints, int variables) {
+    allocate(constraints, variables);
+}
+
+/**
+ * Problem from dense arrays: A row-major with 'variables' columns, b with one
+ * bound per constraint and c with one cost per variable.
+ * @param constraints
+ * @param variables
+ * @param A
+ * @param b
+ * @param c
+ */
+Problem::Problem(int constraints, int variables, const double *A, const double *b, const double *c) {
+    allocate(constraints, variables);
+
+    // One copy, by the whole team: the rows are first touched by the threads
+    // that update them in the pivot loop.
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < m; i++) {
+        memcpy(rows[i], A + (size_t) i * n, n * sizeof (double));
+        rows[i][width()] = b[i];
+    }
+    for (int j = 0; j < n; j++) rows[m][j] = -c[j];
+}
+
+Problem::Problem(Problem&& other) : rows(other.rows), m(other.m), n(other.n), owned(other.owned) {
+    other.rows = 0;
+    other.m = other.n = 0;
+}
+
+Problem& Problem::operator=(Problem&& other) {
+    if (this != &other) {
+        release();
+        rows = other.rows;
+        m = other.m;
+        n = other.n;
+        owned = other.owned;
+        other.rows = 0;
+        other.m = other.n = 0;
+    }
+    return *this;
+}
+
+Problem::~Problem() {
+    release();
+}
+
+/**
+ * Allocate a zero tableau with the slack identity block.
+ * @param constraints
+ * @param variables
+ */
+void Problem::allocate(int constraints, int variables) {
+    release();
+    m = constraints;
+    n = variables;
+    rows = alocate_matrix(m + 1, m + n + 1);
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i <= m; i++) {
+        memset(rows[i], 0, (m + n + 1) * sizeof (double));
+        if (i < m) rows[i][n + i] = 1.0;
+    }
+}
+
+void Problem::release() {
+    if (owned) delete_matrix(rows, m + 1);
+    else delete[] rows;
+    rows = 0;
+    m = n = 0;
+    owned = true;
+}
+
+/**
+ * Use a caller's buffer as the tableau, without copying it: row i of the
+ * tableau starts at data + i * stride. The buffer must outlive the problem,
+ * and solve_in_place leaves the final tableau in it.
+ * @param data (constraints + 1) rows of at least constraints + variables + 1 values
+ * @param constraints
+ * @param variables
+ * @param stride distance between rows, in values
+ */
+void Problem::wrap(double *data, int constraints, int variables, size_t stride) {
+    release();
+    rows = new double *[constraints + 1];
+    for (int i = 0; i <= constraints; i++) rows[i] = data + i * stride;
+    m = constraints;
+    n = variables;
+    owned = false;
+}
+
+/**
+ * Load a problem file; the dimensions come from its name, as for read_data.
+ * @param path
+ * @param stats when set, receives the statistics of the lines read
+ * @return false when the file can not be opened or its name has no dimensions
+ */
+bool Problem::load(const string& path, Input_Stats *stats) {
+    int nL, nC;
+    vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+    char *args[2] = {0, name.data()};
+
+    if (!ifstream(path.c_str()).is_open()) return false;
+    get_dimension(args, nL, nC);
+    if (nL <= 1 || nC <= nL) return false;
+
+    // get_dimension tokenizes the name in place.
+    release();
+    name.assign(path.begin(), path.end());
+    name.push_back('\0');
+    args[1] = name.data();
+    rows = read_data(args, nL, nC, stats);
+    m = nL - 1;
+    n = nC - nL;
+    return true;
+}
+
+/**
+ * Replace the problem with a generated one, see generate_problem.
+ * @param constraints
+ * @param variables
+ * @param density
+ * @param seed
+ */
+void Problem::generate(int constraints, int variables, double density, unsigned seed) {
+    int nL, nC;
+    release();
+    rows = generate_problem(constraints, variables, density, seed, nL, nC);
+    m = constraints;
+    n = variables;
+}
+
+/**
+ * Deep copy.
+ * @return
+ */
+Problem Problem::clone() const {
+    Problem copy;
+    if (rows) {
+        copy.m = m;
+        copy.n = n;
+        copy.rows = alocate_matrix(m + 1, width() + 1);
+        copy_matrix(copy.rows, rows, m + 1, width() + 1);
+    }
+    return copy;
+}
+
+Solver::~Solver() {
+    delete_matrix(work, work_rows);
+}
+
+/**
+ * Solve a copy of the problem, which is left untouched.
+ * @param problem
+ * @return
+ */
+Result Solver::solve(const Problem& problem) {
+    int m = problem.constraints(), nL = m + 1, nC = problem.width() + 1;
+    Cache_Key key;
+    Result r;
+
+    if (cache) {
+        key = Result_Cache::key(problem, opt, crash);
+        if (cache->lookup(key, r)) {
+            // A hit answers the request; a pending cancel is spent with it.
+            cancelled = false;
+            return r;
+        }
+    }
+
+    if (work_rows != nL || work_cols != nC) {
+        delete_matrix(work, work_rows);
+        work = alocate_matrix(nL, nC);
+        work_rows = nL;
+        work_cols = nC;
+    }
+    copy_matrix(work, problem.tableau(), nL, nC);
+
+    // A refactored tableau has no column for the fixed slacks of = rows, so
+    // those problems start from their slack basis.
+    bool equalities = false;
+    for (int i = 0; i < m && !equalities; i++)
+        equalities = problem.tableau()[i][problem.variables() + i] == 0.0;
+
+    vector<int> start;
+    bool warm = false;
+    if (cache && !opt.health && !opt.replay && !equalities && cache->basis(key, m, start)) {
+        warm = refactor_basis(work, problem.tableau(), m, nC - 1, start.data(), opt.kernel);
+        for (int i = 0; warm && i < m; i++)
+            warm = work[i][nC - 1] >= -1e-9;
+        cache->warm_started(warm);
+        if (!warm) copy_matrix(work, problem.tableau(), nL, nC);
+    }
+
+    r = run(work, m, problem.variables(), problem.tableau(), warm ? &start : 0);
+    r.warm_start = warm;
+    // A stop by time or by request depends on the run, not on the problem.
+    if (cache && r.status != SIMPLEX_CANCELLED && r.status != SIMPLEX_TIME_LIMIT && r.status != SIMPLEX_TARGET_REACHED)
+        cache->store(key, r);
+    return r;
+}
+
+/**
+ * Solve the problem in place; it holds the final tableau afterwards. With a
+ * limit set, the original data is copied for the bound of a stopped solve.
+ * @param problem
+ * @return
+ */
+Result Solver::solve_in_place(Problem& problem) {
+    Problem original;
+    if (opt.max_iterations || opt.time_limit > 0 || opt.target < HUGE_VAL) original = problem.clone();
+    return run(problem.tableau(), problem.constraints(), problem.variables(), original.tableau());
+}
+
+/**
+ * Run the pivot loop and read the solution from the final tableau.
+ * @param tableau
+ * @param constraints
+ * @param variables
+ * @param original tableau of the slack basis, for the bound of a stopped
+ *  solve; null when not kept
+ * @param basis basis of the tableau, null for the slack basis
+ * @return
+ */
+Result Solver::run(double **tableau, int constraints, int variables, double **original, const vector<int> *basis) {
+    Result r;
+    Simplex_Options o = opt;
+    int width = constraints + variables;
+    struct timespec start, end;
+
+    // Slack coefficient of every row, -1 for a >= row, read before the first
+    // phase rewrites it: a dual is the reduced cost of the slack times it.
+    double **data = original ? original : tableau;
+    vector<double> sign(constraints);
+    for (int i = 0; i < constraints; i++) sign[i] = data[i][variables + i] < 0 ? -1 : 1;
+
+    if (basis) {
+        r.basis = *basis;
+    } else {
+        r.basis.resize(constraints);
+        for (int i = 0; i < constraints; i++) r.basis[i] = variables + i;
+    }
+    o.basis = r.basis.data();
+    o.status = &r.status;
+    o.cancel = &cancelled;
+
+    clock_gettime(CLOCK_REALTIME, &start);
+    bool found = true;
+    vector<char> fixed;
+    if (!basis && !slack_basis_feasible(tableau, constraints, width)) {
+        // >= and = rows or negative independent values: the first phase looks
+        // for a feasible basis. The health checks start from the slack basis,
+        // they are left out of both phases.
+        fixed.resize(width);
+        o.health = 0;
+        // Round-off of the eliminations of the first phase is not a pivot.
+        o.pivot_tolerance = std::max(o.pivot_tolerance, 1e-9);
+        r.iterations = phase_one(tableau, constraints, width, o, fixed.data());
+        found = r.status == SIMPLEX_OPTIMAL;
+        if (o.max_iterations && r.iterations >= o.max_iterations) {
+            if (found) r.status = SIMPLEX_ITERATION_LIMIT;
+        } else if (o.max_iterations) {
+            o.max_iterations -= r.iterations;
+        }
+        o.fixed = find(fixed.begin(), fixed.end(), 1) != fixed.end() ? fixed.data() : 0;
+        clock_gettime(CLOCK_REALTIME, &end);
+        if (o.time_limit > 0) o.time_limit = std::max(1e-9, o.time_limit - elapsed_seconds(start, end));
+    } else if (crash && !basis && !o.health && !o.replay && !o.record) {
+        // Checked, replayed and recorded solves start from the slack basis,
+        // as a trace holds the pivots from there.
+        r.crash = crash_basis(tableau, constraints, width, o);
+    }
+    if (r.status == SIMPLEX_OPTIMAL)
+        r.iterations += simplex(tableau, constraints, width, o);
+    clock_gettime(CLOCK_REALTIME, &end);
+    cancelled = false;
+
+    r.time = elapsed_seconds(start, end);
+    if (!found) {
+        // No feasible basis, so no solution to report.
+        r.objective = 0;
+        r.x.assign(variables, 0.0);
+        r.duals.assign(constraints, 0.0);
+        r.basis.clear();
+        r.bound = r.gap = HUGE_VAL;
+        return r;
+    }
+    r.objective = tableau[constraints][width];
+    r.x.assign(variables, 0.0);
+    for (int i = 0; i < constraints; i++)
+        if (r.basis[i] < variables) r.x[r.basis[i]] = tableau[i][width];
+    r.duals.resize(constraints);
+    for (int i = 0; i < constraints; i++) r.duals[i] = sign[i] * tableau[constraints][variables + i];
+    if (r.status == SIMPLEX_OPTIMAL) r.bound = r.objective;
+    else if (r.status == SIMPLEX_UNBOUNDED) r.bound = HUGE_VAL;
+    else r.bound = original ? objective_bound(tableau, original, constraints, width) : HUGE_VAL;
+    r.gap = r.bound - r.objective;
+    return r;
+}
@@ -0,0 +1,186 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  solver.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Library API of the parallel simplex: problems built in memory or
+ *  loaded from files, solvers with their own configuration and results with
+ *  a status code. No global state and no process exit, so several solves can
+ *  run in one process.
+ * @language: C++
+ *
+ * @section Description
+ *  A Problem owns its tableau, in the layout of the input files:
+ *
+ *  | A  I  b|
+ *  |-c  0  0|
+ *
+ *  or, when it wraps a caller's contiguous buffer in that layout, only the
+ *  row pointers into it; the buffer is then solved without any copy.
+ *
+ *  The slack coefficient of a row gives its sense: 1 for <=, -1 for >= and 0
+ *  for =. When the slack basis is not feasible (>= or = rows, or negative
+ *  independent values), run starts with the first phase of the two-phase
+ *  method (phase_one), SIMPLEX_INFEASIBLE when the constraints have no
+ *  solution. A solve that ends before a feasible basis is found has no
+ *  solution: zero x and duals, an empty basis and a bound of HUGE_VAL. The
+ *  problems with = rows do not start from a cached basis, and the health
+ *  checks only run on the solves that start from the slack basis.
+ *
+ *  With set_crash, a solve from a feasible slack basis first brings in the
+ *  structural columns of a triangular crash basis (crash_basis), so the pivot
+ *  loop starts closer to the optimum; Result::crash has their number, 0 when
+ *  they are too few to be applied. It is opt-in: on sparse problems it saves
+ *  iterations, on dense ones it can add some. The health checks, the replays,
+ *  the recorded solves and the solves with a first phase or from a cached
+ *  basis do not use it.
+ *
+ *  A Solver solves a copy of the problem in a work tableau that it keeps for
+ *  the next solve of the same dimensions (solve), or the problem itself, which
+ *  then holds the final tableau (solve_in_place). The number of threads is
+ *  the solver's, it does not change the omp_set_num_threads setting.
+ *
+ *  With a result cache (result_cache.h), solve returns the stored result of
+ *  an identical problem, and starts from the stored basis of a problem of the
+ *  same shape when that basis is primal feasible; the health checks and the
+ *  replays always start from the slack basis. solve_in_place does not use
+ *  the cache, as a hit would leave the tableau unsolved.
+ *
+ *  A solve can be stopped without ending the process: by the progress
+ *  callback, which sees every iteration, or by cancel, from any thread. It
+ *  stops at the next iteration boundary with status SIMPLEX_CANCELLED and the
+ *  solution of the current basis, which is primal feasible. The limits on
+ *  iterations, time and objective (set_target) stop it in the same way. A
+ *  stopped result has an upper bound of the optimal objective
+ *  (objective_bound), HUGE_VAL when none is found; solve_in_place copies the
+ *  data for it only when a limit is set.
+ *
+ *  Example:
+ *
+ *    Problem p(2, 2);
+ *    p.set_cost(0, 3); p.set_cost(1, 5);
+ *    p.set_coefficient(0, 0, 1); p.set_bound(0, 4);
+ *    p.set_coefficient(1, 1, 2); p.set_bound(1, 12);
+ *    Solver s;
+ *    s.set_threads(4);
+ *    Result r = s.solve(p);
+ *    if (r.status == SIMPLEX_OPTIMAL) use(r.objective, r.x);
+ *
+ * @subsection Compilation
+ *   The library is the set of translation units of the solver:
+ *
+ *  g++ -Ofast -fopenmp -c solver.cpp incremental.cpp model_builder.cpp result_cache.cpp simplex.cpp pivot_trace.cpp telemetry.cpp trace_events.cpp sync_stats.cpp roofline.cpp health.cpp flight_recorder.cpp metrics.cpp energy.cpp reference.cpp
+ *  ar rcs libsimplex.a solver.o incremental.o model_builder.o result_cache.o simplex.o pivot_trace.o telemetry.o trace_events.o sync_stats.o roofline.o health.o flight_recorder.o metrics.o energy.o reference.o
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "simplex.h"
+
+using namespace std;
+
+class Result_Cache;
+
+class Problem {
+public:
+    Problem() {}
+    Problem(int constraints, int variables);
+    Problem(int constraints, int variables, const double *A, const double *b, const double *c);
+    Problem(Problem&& other);
+    Problem& operator=(Problem&& other);
+    ~Problem();
+
+    bool load(const string& path, Input_Stats *stats = 0);
+    void wrap(double *data, int constraints, int variables, size_t stride);
+    void generate(int constraints, int variables, double density, unsigned seed);
+    Problem clone() const;
+
+    void set_cost(int j, double c) { rows[m][j] = -c; }
+    void set_coefficient(int i, int j, double a) { rows[i][j] = a; }
+    void set_bound(int i, double b) { rows[i][width()] = b; }
+
+    int constraints() const { return m; }
+    int variables() const { return n; }
+    int width() const { return m + n; }         // index of the independent values column
+    bool empty() const { return rows == 0; }
+    double ** tableau() const { return rows; }
+
+private:
+    void allocate(int constraints, int variables);
+    void release();
+
+    double **rows = 0;
+    int m = 0, n = 0;
+    bool owned = true;          // false for the rows of a wrapped buffer
+
+    Problem(const Problem&);
+    Problem& operator=(const Problem&);
+};
+
+struct Result {
+    Simplex_Status status = SIMPLEX_OPTIMAL;
+    int iterations = 0;
+    double objective = 0;
+    double time = 0;            // seconds in the pivot loop
+    vector<double> x;           // structural variables
+    vector<double> duals;       // one per constraint, d objective / d rhs
+    vector<int> basis;          // basic variable of every row
+    double bound = 0;           // upper bound of the optimal objective, HUGE_VAL when unknown
+    double gap = 0;             // bound - objective
+    bool cached = false;        // returned by the result cache, without a solve
+    bool warm_start = false;    // started from a cached basis
+    int crash = 0;              // structural columns of the crash basis
+};
+
+class Solver {
+public:
+    Solver() {}
+    ~Solver();
+
+    void set_threads(int threads) { opt.threads = threads; }
+    void set_chunk(int chunk) { opt.chunk = chunk; }
+    void set_kernel(int kernel) { opt.kernel = kernel; }
+    void set_max_iterations(int iterations) { opt.max_iterations = iterations; }
+    void set_time_limit(double seconds) { opt.time_limit = seconds; }
+    void set_target(double objective) { opt.target = objective; }
+    void set_cache(Result_Cache *results) { cache = results; }
+    void set_crash(bool enabled) { crash = enabled; }
+    void set_progress(const function<bool(const Simplex_Progress&)>& callback) { opt.on_progress = callback; }
+
+    // Stops the running solve at its next iteration; without one, the next
+    // solve stops before its first iteration. Every solve clears the request
+    // when it returns, a cache hit included.
+    void cancel() { cancelled = true; }
+
+    // Instrumentation hooks of the pivot loop; basis, status and cancel are
+    // managed by the solver.
+    Simplex_Options& options() { return opt; }
+
+    Result solve(const Problem& problem);
+    Result solve_in_place(Problem& problem);
+
+private:
+    Result run(double **tableau, int constraints, int variables, double **original, const vector<int> *basis = 0);
+
+    Simplex_Options opt;
+    Result_Cache *cache = 0;
+    bool crash = false;
+    atomic<bool> cancelled{false};
+    double **work = 0;
+    int work_rows = 0, work_cols = 0;
+
+    Solver(const Solver&);
+    Solver& operator=(const Solver&);
+};
+
+#endif
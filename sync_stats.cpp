@@ -0,0 +1,189 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  sync_stats.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Synchronization cost and load imbalance accounting.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <algorithm>
+
+#include "sync_stats.h"
+#include "telemetry.h"
+
+// Worksharing loops that precede each barrier, and their schedule.
+static const char *sync_loops[SYNC_COUNT] = {
+    "pricing", "ratio test", "pivot selection (single)", "normalize",
+    "eliminate + objective update", "bookkeeping (single)"
+};
+
+/**
+ * Reset the counters for a team.
+ * @param team number of threads
+ * @param loop_chunk chunk of the guided loops
+ */
+void Sync_Stats::prepare(int team, int loop_chunk) {
+    delete [] slots;
+    slots = new Slot[team]();
+    threads = team;
+    chunk = loop_chunk;
+    for (int p = 0; p < SYNC_COUNT; p++) totals[p] = Sync_Summary();
+}
+
+/**
+ * Publish the arrival of a thread at a barrier. Called before the barrier.
+ * @param tid
+ * @param point
+ * @param arrival
+ * @param work time worked since the previous barrier
+ */
+void Sync_Stats::arrive(int tid, int point, double arrival, double work) {
+    slots[tid].arrival[point] = arrival;
+    slots[tid].work[point] = work;
+}
+
+/**
+ * Add the wait of a thread at a barrier. Called after the barrier.
+ * @param tid
+ * @param point
+ * @param wait
+ */
+void Sync_Stats::depart(int tid, int point, double wait) {
+    slots[tid].wait[point] += wait;
+}
+
+/**
+ * Fold the arrivals and the work of a barrier instance. Called by a single
+ * thread after the barrier and before the next one.
+ * @param point
+ */
+void Sync_Stats::close(int point) {
+    double first = slots[0].arrival[point], last = first;
+    double work_max = 0, work_sum = 0;
+
+    for (int t = 0; t < threads; t++) {
+        first = min(first, slots[t].arrival[point]);
+        last = max(last, slots[t].arrival[point]);
+        work_max = max(work_max, slots[t].work[point]);
+        work_sum += slots[t].work[point];
+    }
+
+    Sync_Summary& s = totals[point];
+    s.instances++;
+    s.skew += last - first;
+    s.max_skew = max(s.max_skew, last - first);
+    s.work_max += work_max;
+    s.work_mean += work_sum / threads;
+}
+
+/**
+ * Thread-seconds waited at every barrier.
+ * @return
+ */
+double Sync_Stats::total_wait() const {
+    double wait = 0;
+    for (int t = 0; t < threads; t++)
+        for (int p = 0; p < SYNC_COUNT; p++)
+            wait += slots[t].wait[p];
+    return wait;
+}
+
+/**
+ * Fraction of the team's time spent waiting at barriers.
+ * @param wall
+ * @return
+ */
+double Sync_Stats::overhead(double wall) const {
+    return threads && wall > 0 ? total_wait() / (threads * wall) : 0;
+}
+
+/**
+ * Imbalance factor of the work preceding a barrier: 1 is perfect balance,
+ * the number of threads means a single thread did all the work.
+ * @param point
+ * @return
+ */
+double Sync_Stats::imbalance(int point) const {
+    return totals[point].work_mean > 0 ? totals[point].work_max / totals[point].work_mean : 1;
+}
+
+/**
+ * Schedule of the worksharing loops preceding a barrier.
+ * @param point
+ * @return
+ */
+string Sync_Stats::schedule(int point) const {
+    switch (point) {
+        case SYNC_PRICING:
+        case SYNC_RATIO:
+            return "guided," + to_string(chunk);
+        case SYNC_NORMALIZE:
+            return "static";
+        case SYNC_OBJECTIVE:
+            return "static + guided," + to_string(chunk);
+        default:
+            return "single";
+    }
+}
+
+/**
+ * Human readable end-of-run report.
+ * @param wall solve time in seconds
+ * @return
+ */
+string Sync_Stats::report(double wall) const {
+    char line[256];
+    string out;
+
+    snprintf(line, sizeof (line), "sync overhead: %.2f%% of %d threads x %.6f s\n", 100.0 * overhead(wall), threads, wall);
+    out += line;
+    snprintf(line, sizeof (line), "%-10s %-30s %-22s %9s %12s %12s %12s %9s\n",
+             "barrier", "preceding loops", "schedule", "count", "wait (s)", "mean skew", "max skew", "imbalance");
+    out += line;
+
+    for (int p = 0; p < SYNC_COUNT; p++) {
+        const Sync_Summary& s = totals[p];
+        double wait = 0;
+        for (int t = 0; t < threads; t++) wait += slots[t].wait[p];
+
+        snprintf(line, sizeof (line), "%-10s %-30s %-22s %9ld %12.6f %12.3e %12.3e %9.3f\n",
+                 sync_name(p), sync_loops[p], schedule(p).c_str(), s.instances, wait,
+                 s.instances ? s.skew / s.instances : 0.0, s.max_skew, imbalance(p));
+        out += line;
+    }
+    return out;
+}
+
+/**
+ * Report as a JSON object.
+ * @param wall solve time in seconds
+ * @return
+ */
+string Sync_Stats::json(double wall) const {
+    string out = "{\"threads\": " + to_string(threads) + ", \"overhead\": ";
+    char number[32];
+
+    snprintf(number, sizeof (number), "%.6g", overhead(wall));
+    out += string(number) + ", \"barriers\": [";
+
+    for (int p = 0; p < SYNC_COUNT; p++) {
+        const Sync_Summary& s = totals[p];
+        double wait = 0;
+        for (int t = 0; t < threads; t++) wait += slots[t].wait[p];
+
+        Json_Line line;
+        line.add("barrier", sync_name(p)).add("loops", sync_loops[p]).add("schedule", schedule(p))
+            .add("instances", s.instances).add("wait", wait)
+            .add("mean_skew", s.instances ? s.skew / s.instances : 0.0).add("max_skew", s.max_skew)
+            .add("imbalance", imbalance(p));
+        out += (p ? ", " : "") + line.str();
+    }
+    return out + "]}";
+}
@@ -0,0 +1,81 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  sync_stats.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Synchronization cost and load imbalance accounting for the barriers
+ *  of the pivot loop.
+ * @language: C++
+ *
+ * @section Description
+ *  At every barrier each thread publishes its arrival time and the time it
+ *  worked since it left the previous barrier, then adds its wait to its own
+ *  counters. After the barrier thread 0 folds the arrivals into the arrival
+ *  skew (last minus first arrival) and the work into the imbalance factor of
+ *  the segment (sum of the slowest thread's work over sum of the mean work).
+ *  Each barrier is named after the worksharing loops that precede it.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef SYNC_STATS_H
+#define SYNC_STATS_H
+
+#include <string>
+
+#include "simplex.h"
+
+using namespace std;
+
+/**
+ * Totals of one synchronization point over a run.
+ */
+struct Sync_Summary {
+    long instances = 0;
+    double wait = 0;        // thread-seconds waited
+    double skew = 0;        // sum of the arrival skews
+    double max_skew = 0;
+    double work_max = 0;    // sum over instances of the slowest thread's work
+    double work_mean = 0;   // sum over instances of the mean work
+};
+
+class Sync_Stats {
+public:
+    Sync_Stats() {}
+    ~Sync_Stats() { delete [] slots; }
+
+    void prepare(int threads, int chunk);
+    void arrive(int tid, int point, double arrival, double work);
+    void depart(int tid, int point, double wait);
+    void close(int point);
+
+    int team() const { return threads; }
+    double total_wait() const;
+    double overhead(double wall) const;
+    double imbalance(int point) const;
+    const Sync_Summary& summary(int point) const { return totals[point]; }
+    string schedule(int point) const;
+
+    string report(double wall) const;
+    string json(double wall) const;
+
+private:
+    struct alignas(64) Slot {
+        double arrival[SYNC_COUNT];
+        double work[SYNC_COUNT];
+        double wait[SYNC_COUNT];
+    };
+
+    Slot *slots = 0;
+    int threads = 0;
+    int chunk = 1;
+    Sync_Summary totals[SYNC_COUNT];
+
+    Sync_Stats(const Sync_Stats&);
+    Sync_Stats& operator=(const Sync_Stats&);
+};
+
+#endif
@@ -0,0 +1,203 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  telemetry.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Structured JSON-lines telemetry of the solver runs.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <unistd.h>
+
+#include "telemetry.h"
+
+/**
+ * Escape a string for JSON output.
+ * @param s
+ * @return the quoted string
+ */
+string json_escape(const string& s) {
+    string out = "\"";
+    for (size_t k = 0; k < s.size(); k++) {
+        char c = s[k];
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char) c < 0x20) continue;
+        out += c;
+    }
+    return out + "\"";
+}
+
+void Json_Line::key(const char *name) {
+    out << (first ? "{" : ", ") << json_escape(name) << ": ";
+    first = false;
+}
+
+Json_Line& Json_Line::add(const char *name, const string& value) {
+    key(name);
+    out << json_escape(value);
+    return *this;
+}
+
+Json_Line& Json_Line::add(const char *name, const char *value) {
+    return add(name, string(value));
+}
+
+Json_Line& Json_Line::add(const char *name, double value) {
+    char number[32];
+    key(name);
+    if (isfinite(value)) {
+        snprintf(number, sizeof (number), "%.17g", value);
+        out << number;
+    } else
+        out << "null";
+    return *this;
+}
+
+Json_Line& Json_Line::add(const char *name, bool value) {
+    key(name);
+    out << (value ? "true" : "false");
+    return *this;
+}
+
+Json_Line& Json_Line::add(const char *name, long value) {
+    key(name);
+    out << value;
+    return *this;
+}
+
+Json_Line& Json_Line::add_raw(const char *name, const string& json) {
+    key(name);
+    out << json;
+    return *this;
+}
+
+/**
+ * Open the telemetry file in append mode and start the writer thread.
+ * @param name
+ * @param iterations also write one record per iteration
+ * @return false if the file can not be opened
+ */
+bool Telemetry::open(const string& name, bool iterations) {
+    close();
+
+    file_buffer.resize(1 << 20);
+    file.rdbuf()->pubsetbuf(file_buffer.data(), file_buffer.size());
+    file.open(name.c_str(), ofstream::app);
+    if (!file.is_open()) return false;
+
+    id = to_string(getpid()) + "-" + to_string(time(0));
+    per_iteration = iterations;
+    stopping = false;
+    batch.reserve(BATCH);
+    started = true;
+    worker = thread(&Telemetry::writer, this);
+    return true;
+}
+
+/**
+ * Write the pending records, stop the writer thread and close the file.
+ */
+void Telemetry::close() {
+    if (!started) return;
+
+    flush();
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_one();
+    worker.join();
+    file.close();
+    started = false;
+}
+
+/**
+ * Queue an iteration record. Called by a single thread of the pivot loop.
+ * @param record
+ */
+void Telemetry::iteration(const Iteration_Record& record) {
+    batch.push_back(record);
+    if (batch.size() >= BATCH) flush();
+}
+
+/**
+ * Start the summary object of a run.
+ * @return
+ */
+Json_Line Telemetry::run_line() const {
+    Json_Line line;
+    line.add("type", "run").add("run", id);
+    return line;
+}
+
+/**
+ * Queue the summary object of a run, started with run_line.
+ * @param line
+ */
+void Telemetry::run(const Json_Line& line) {
+    flush();
+    {
+        lock_guard<mutex> guard(lock);
+        lines.push_back(line.str());
+    }
+    ready.notify_one();
+}
+
+/**
+ * Hand the current batch of iteration records to the writer thread.
+ */
+void Telemetry::flush() {
+    if (batch.empty()) return;
+    {
+        lock_guard<mutex> guard(lock);
+        if (queue.empty())
+            queue.swap(batch);
+        else
+            queue.insert(queue.end(), batch.begin(), batch.end());
+    }
+    batch.clear();
+    batch.reserve(BATCH);
+    ready.notify_one();
+}
+
+void Telemetry::write_iteration(const Iteration_Record& record) {
+    Json_Line line;
+    line.add("type", "iteration").add("run", id).add("iteration", record.iteration)
+        .add("entering", record.entering).add("leaving", record.leaving)
+        .add("pivot", record.pivot).add("step", record.step).add("objective", record.objective);
+    for (int k = 0; k < PHASE_COUNT; k++)
+        line.add((string(phase_name(k)) + "_time").c_str(), record.phase[k]);
+    file << line.str() << '\n';
+}
+
+/**
+ * Body of the writer thread: formats and writes whatever has been queued.
+ */
+void Telemetry::writer() {
+    vector<Iteration_Record> records;
+    vector<string> runs;
+
+    for (;;) {
+        {
+            unique_lock<mutex> guard(lock);
+            ready.wait(guard, [this] { return stopping || !queue.empty() || !lines.empty(); });
+            records.swap(queue);
+            runs.swap(lines);
+            if (records.empty() && runs.empty() && stopping) break;
+        }
+
+        for (size_t k = 0; k < records.size(); k++)
+            write_iteration(records[k]);
+        for (size_t k = 0; k < runs.size(); k++)
+            file << runs[k] << '\n';
+        records.clear();
+        runs.clear();
+    }
+    file.flush();
+}
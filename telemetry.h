@@ -0,0 +1,118 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  telemetry.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Structured JSON-lines telemetry of the solver runs.
+ * @language: C++
+ *
+ * @section Description
+ *  Every run appends one JSON object with its configuration, dimensions,
+ *  timings and iteration statistics ("type": "run") and, when enabled, one
+ *  object per iteration ("type": "iteration") with the pivot, the objective,
+ *  the step and the time of each phase. Both kinds carry the same "run" id.
+ *
+ *  The pivot loop only copies iteration records into a local batch; full batches
+ *  are handed to a background thread that formats and writes them, so the file
+ *  output never stalls the loop.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "simplex.h"
+
+using namespace std;
+
+struct Iteration_Record {
+    int iteration;
+    int entering;
+    int leaving;
+    double pivot;
+    double step;
+    double objective;
+    double phase[PHASE_COUNT];  // seconds spent in each phase of the iteration
+};
+
+/**
+ * Builder of a single-line JSON object.
+ */
+class Json_Line {
+public:
+    Json_Line& add(const char *key, const string& value);
+    Json_Line& add(const char *key, const char *value);
+    Json_Line& add(const char *key, double value);
+    Json_Line& add(const char *key, bool value);
+    Json_Line& add(const char *key, long value);
+    Json_Line& add(const char *key, int value) { return add(key, (long) value); }
+    Json_Line& add_raw(const char *key, const string& json);
+    string str() const { return out.str() + "}"; }
+
+    Json_Line() {}
+    Json_Line(const Json_Line& other) : first(other.first) { out << other.out.str(); }
+
+private:
+    void key(const char *name);
+    ostringstream out;
+    bool first = true;
+};
+
+string json_escape(const string& s);
+
+class Telemetry {
+public:
+    Telemetry() {}
+    ~Telemetry() { close(); }
+
+    bool open(const string& name, bool per_iteration);
+    void close();
+
+    bool is_open() const { return started; }
+    bool iterations_enabled() const { return started && per_iteration; }
+    const string& run_id() const { return id; }
+
+    void iteration(const Iteration_Record& record);
+    Json_Line run_line() const;
+    void run(const Json_Line& line);
+    void flush();
+
+private:
+    static const size_t BATCH = 256;
+
+    void writer();
+    void write_iteration(const Iteration_Record& record);
+
+    ofstream file;
+    vector<char> file_buffer;
+    string id;
+    bool per_iteration = false;
+    bool started = false;
+
+    // Owned by the producer, handed over in batches.
+    vector<Iteration_Record> batch;
+
+    mutex lock;
+    condition_variable ready;
+    vector<Iteration_Record> queue;
+    vector<string> lines;
+    bool stopping = false;
+    thread worker;
+
+    Telemetry(const Telemetry&);
+    Telemetry& operator=(const Telemetry&);
+};
+
+#endif
@@ -0,0 +1,112 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  trace_events.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Per-thread recording of the phases of the pivot loop and Chrome
+ *  trace-event export.
+ * @language: C++
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <fstream>
+
+#include "trace_events.h"
+
+/**
+ * Enable the recorder.
+ * @param events capacity of the ring buffer of each thread
+ * @param sample record one iteration out of 'sample'
+ */
+void Trace_Recorder::open(size_t events, int sample) {
+    capacity = events;
+    every = sample > 0 ? sample : 1;
+    origin = omp_get_wtime();
+}
+
+/**
+ * Allocate the rings for a team. Must be called before the parallel region;
+ * the events of a previous team are kept when the team does not grow.
+ * @param team
+ */
+void Trace_Recorder::prepare(int team) {
+    if (!enabled() || team <= threads) return;
+
+    Ring *grown = new Ring[team];
+    for (int t = 0; t < team; t++) {
+        grown[t].events.resize(capacity);
+        if (t < threads) {
+            grown[t].events.swap(rings[t].events);
+            grown[t].head.store(rings[t].head.load());
+        }
+    }
+    delete [] rings;
+    rings = grown;
+    threads = team;
+}
+
+/**
+ * Record an event in the ring of the calling thread.
+ * @param tid
+ * @param id
+ * @param iteration
+ * @param begin
+ * @param end
+ */
+void Trace_Recorder::record(int tid, int id, int iteration, double begin, double end) {
+    Ring& ring = rings[tid];
+    size_t head = ring.head.load(memory_order_relaxed);
+    Trace_Event& e = ring.events[head % capacity];
+
+    e.begin = begin;
+    e.end = end;
+    e.iteration = iteration;
+    e.id = id;
+    ring.head.store(head + 1, memory_order_release);
+}
+
+/**
+ * Write the recorded events as Chrome trace-event JSON, one complete ("X")
+ * event per phase with its begin time and duration in microseconds.
+ * @param name
+ * @return false if the file can not be written
+ */
+bool Trace_Recorder::dump(const string& name) const {
+    ofstream out(name.c_str());
+    if (!out.is_open()) return false;
+
+    char line[256];
+    bool first = true;
+
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    for (int t = 0; t < threads; t++) {
+        snprintf(line, sizeof (line),
+                 "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"omp thread %d\"}}",
+                 first ? "" : ",\n", t, t);
+        out << line;
+        first = false;
+
+        const Ring& ring = rings[t];
+        size_t head = ring.head.load(memory_order_acquire);
+        size_t start = head > capacity ? head - capacity : 0;
+
+        for (size_t k = start; k < head; k++) {
+            const Trace_Event& e = ring.events[k % capacity];
+            string event = e.id < PHASE_COUNT ? phase_name(e.id) : string("wait:") + sync_name(e.id - PHASE_COUNT);
+
+            snprintf(line, sizeof (line),
+                     ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                     "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"iteration\": %d}}",
+                     event.c_str(), e.id < PHASE_COUNT ? "phase" : "sync", t,
+                     (e.begin - origin) * 1e6, (e.end - e.begin) * 1e6, e.iteration);
+            out << line;
+        }
+    }
+    out << "\n]}\n";
+    return out.good();
+}
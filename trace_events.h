@@ -0,0 +1,70 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  trace_events.h
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Per-thread recording of the phases of the pivot loop, exported as
+ *  Chrome trace-event JSON that can be opened in Perfetto or chrome://tracing.
+ * @language: C++
+ *
+ * @section Description
+ *  Each thread owns a fixed-size ring buffer and is its only writer, so
+ *  recording takes no lock; when a ring is full the oldest events are
+ *  overwritten. Only one iteration out of 'every' is recorded, which keeps the
+ *  trace of a long solve bounded and readable. Event ids below PHASE_COUNT are
+ *  phases, and PHASE_COUNT + s is the wait at synchronization point s.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef TRACE_EVENTS_H
+#define TRACE_EVENTS_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "simplex.h"
+
+using namespace std;
+
+struct Trace_Event {
+    double begin;       // omp_get_wtime() seconds
+    double end;
+    int iteration;
+    int id;             // phase, or PHASE_COUNT + synchronization point
+};
+
+class Trace_Recorder {
+public:
+    Trace_Recorder() {}
+    ~Trace_Recorder() { delete [] rings; }
+
+    void open(size_t capacity, int every);
+    void prepare(int threads);
+    bool enabled() const { return capacity > 0; }
+    bool sampled(int iteration) const { return capacity > 0 && iteration % every == 0; }
+    void record(int tid, int id, int iteration, double begin, double end);
+    bool dump(const string& name) const;
+
+private:
+    struct alignas(64) Ring {
+        vector<Trace_Event> events;
+        atomic<size_t> head;
+        Ring() : head(0) {}
+    };
+
+    Ring *rings = 0;
+    int threads = 0;
+    size_t capacity = 0;
+    int every = 1;
+    double origin = 0;
+
+    Trace_Recorder(const Trace_Recorder&);
+    Trace_Recorder& operator=(const Trace_Recorder&);
+};
+
+#endif
@@ -0,0 +1,404 @@
+// ----------------------------------------------------------------------------
+/**
+ * @file  verify.cpp
+ * @author Demétrios A. M. Coutinho
+ * @email demetrios.coutinho@ifrn.edu.br
+ * @author Samuel Xavier de Souza
+ * @email samuel@dca.ufrn.edu.br
+ * @date    08/2017
+ *
+ * @brief Verification of the parallel simplex against the serial reference on
+ *  a problem file or on families of generated problems.
+ * @language: C++
+ *
+ * @section Description
+ *  Every case (problem, thread count, chunk and kernel) is solved by the
+ *  parallel loop and by the reference, and compared on the objective, the
+ *  pivot sequence and the final tableau. The reference of a problem is
+ *  computed once for all of its cases. One line is printed per case; the exit
+ *  status is 1 when some case fails.
+ *
+ *  --checks runs instead the fixed checks of the library pieces with a known
+ *  answer: Solver and the incremental model on >= and = rows, objective and
+ *  duals, and the energy meter on a temporary powercap tree whose package
+ *  counter wraps around.
+ *
+ * @subsection Compilation
+ *   To compile this file you need to run the following command:
+ *
+ *  g++ -Ofast verify.cpp reference.cpp solver.cpp incremental.cpp model_builder.cpp result_cache.cpp simplex.cpp pivot_trace.cpp telemetry.cpp trace_events.cpp sync_stats.cpp roofline.cpp health.cpp flight_recorder.cpp metrics.cpp energy.cpp -fopenmp -Wall -o verify
+ *
+ * @subsection usage
+ *   ./verify (--file /PATH/MxN | --generate MxN[,MxN...]) [options]
+ *   ./verify --checks
+ *
+ *   --density 0.1,1      densities of the generated problems (default 1)
+ *   --seeds 1:100        seeds of the generated problems, a range or a list (default 1)
+ *   --threads 1,2,4      thread counts (default 1)
+ *   --chunks 1,100       chunk sizes (default 1)
+ *   --kernels a,b        row-update kernels (default every kernel)
+ *   --objective-tol x    relative objective tolerance (default 1e-9)
+ *   --tableau-tol x      relative tableau tolerance (default 1e-7)
+ *   --failures           print only the failed cases
+ *
+ *   Example on 100 generated 200x200 problems of two densities:
+ *
+ *   ./verify --generate 200x200 --density 0.1,1 --seeds 1:100 --threads 1,4 --chunks 1,64
+ */
+// ----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "simplex.h"
+#include "reference.h"
+#include "incremental.h"
+#include "model_builder.h"
+#include "energy.h"
+
+/**
+ * Split a comma separated list.
+ * @param s
+ * @return
+ */
+static vector<string> split(const string& s) {
+    vector<string> items;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ',')) items.push_back(item);
+    return items;
+}
+
+/**
+ * Comma separated list of integers, where "a:b" stands for the range a..b.
+ * @param s
+ * @return
+ */
+static vector<int> int_list(const string& s) {
+    vector<string> items = split(s);
+    vector<int> vec;
+
+    for (size_t k = 0; k < items.size(); k++) {
+        int first, last;
+        if (sscanf(items[k].c_str(), "%d:%d", &first, &last) == 2)
+            for (int v = first; v <= last; v++) vec.push_back(v);
+        else if (sscanf(items[k].c_str(), "%d", &first) == 1)
+            vec.push_back(first);
+    }
+    return vec;
+}
+
+/**
+ * Problem of a family.
+ */
+struct Family_Problem {
+    string name;
+    int constraints = 0;
+    int variables = 0;
+    double density = 1;
+    unsigned seed = 1;
+};
+
+/**
+ * Print the outcome of a check.
+ * @param name
+ * @param r
+ * @param expected
+ * @return 1 when it failed
+ */
+static int check_objective(const string& name, const Result& r, double expected) {
+    bool ok = r.status == SIMPLEX_OPTIMAL && fabs(r.objective - expected) <= 1e-9 * (1 + fabs(expected));
+    printf("%s: %s objective %.9g expected %.9g %s\n", name.c_str(), status_name(r.status), r.objective, expected,
+           ok ? "OK" : "FAIL");
+    return !ok;
+}
+
+/**
+ * Print the outcome of a check of the duals.
+ * @param name
+ * @param r
+ * @param expected
+ * @return 1 when it failed
+ */
+static int check_duals(const string& name, const Result& r, const vector<double>& expected) {
+    bool ok = r.duals.size() == expected.size();
+    string got;
+
+    for (size_t i = 0; i < r.duals.size(); i++) {
+        got += (i ? " " : "") + to_string(r.duals[i]);
+        if (ok) ok = fabs(r.duals[i] - expected[i]) <= 1e-9 * (1 + fabs(expected[i]));
+    }
+    printf("%s: duals %s %s\n", name.c_str(), got.c_str(), ok ? "OK" : "FAIL");
+    return !ok;
+}
+
+/**
+ * The incremental model on the senses of the slack coefficients, against the
+ * known optimum and Solver, before and after an edit of the bounds.
+ * @return the number of failed checks
+ */
+static int live_model_checks() {
+    int failed = 0;
+
+    // maximize -x, x >= 2; then x >= 5.
+    {
+        Model_Builder b;
+        Problem p;
+        int x = b.add_variable(-1);
+        b.add_coefficient(b.add_constraint(ROW_GREATER_EQUAL, 2), x, 1);
+        b.build(p);
+        Solver s;
+        Live_Model model(p);
+        Result r = s.solve(p);
+        failed += check_objective("solver, >= row", r, -2);
+        failed += check_duals("solver, >= row", r, vector<double>(1, -1));
+        r = model.reoptimize();
+        failed += check_objective("live model, >= row", r, -2);
+        failed += check_duals("live model, >= row", r, vector<double>(1, -1));
+        model.set_bound(0, 5);
+        failed += check_objective("live model, >= row, new bound", model.reoptimize(), -5);
+    }
+
+    // maximize x - y, x + y = 3, x <= 1; then x + y = 4.
+    {
+        Model_Builder b;
+        Problem p;
+        int x = b.add_variable(1), y = b.add_variable(-1);
+        int row = b.add_constraint(ROW_EQUAL, 3);
+        b.add_coefficient(row, x, 1);
+        b.add_coefficient(row, y, 1);
+        b.add_coefficient(b.add_constraint(ROW_LESS_EQUAL, 1), x, 1);
+        b.build(p);
+        Solver s;
+        Live_Model model(p);
+        vector<double> duals = {-1, 2};
+        Result r = s.solve(p);
+        failed += check_objective("solver, = row", r, -1);
+        failed += check_duals("solver, = row", r, duals);
+        r = model.reoptimize();
+        failed += check_objective("live model, = row", r, -1);
+        failed += check_duals("live model, = row", r, duals);
+        model.set_bound(0, 4);
+        failed += check_objective("live model, = row, new bound", model.reoptimize(), -2);
+    }
+    return failed;
+}
+
+/**
+ * Write one value to a file of the fake powercap tree.
+ * @param path
+ * @param value
+ */
+static void write_value(const string& path, const string& value) {
+    FILE *file = fopen(path.c_str(), "w");
+
+    if (!file) return;
+    fprintf(file, "%s\n", value.c_str());
+    fclose(file);
+}
+
+/**
+ * Print the outcome of an energy check.
+ * @param name
+ * @param joules
+ * @param expected
+ * @return 1 when it failed
+ */
+static int check_joules(const string& name, double joules, double expected) {
+    bool ok = fabs(joules - expected) <= 1e-9;
+    printf("%s: %.9g J expected %.9g J %s\n", name.c_str(), joules, expected, ok ? "OK" : "FAIL");
+    return !ok;
+}
+
+/**
+ * The energy meter on a temporary powercap tree: a package zone whose counter
+ * wraps around at max_energy_range_uj between the two samples, and a DRAM
+ * subzone that does not.
+ * @return the number of failed checks
+ */
+static int energy_checks() {
+    char root[] = "/tmp/powercapXXXXXX";
+    int failed = 0;
+
+    if (!mkdtemp(root)) {
+        printf("energy meter: no temporary directory FAIL\n");
+        return 1;
+    }
+    string package = string(root) + "/intel-rapl:0", dram = package + "/intel-rapl:0:0";
+    mkdir(package.c_str(), 0700);
+    mkdir(dram.c_str(), 0700);
+    write_value(package + "/name", "package-0");
+    write_value(package + "/max_energy_range_uj", "1000000");
+    write_value(package + "/energy_uj", "900000");
+    write_value(dram + "/name", "dram");
+    write_value(dram + "/max_energy_range_uj", "1000000");
+    write_value(dram + "/energy_uj", "1000");
+
+    Energy_Meter meter;
+    if (!meter.open(root) || !meter.has(ENERGY_PACKAGE) || !meter.has(ENERGY_DRAM)) {
+        printf("energy meter: zones not found in %s FAIL\n", root);
+        failed++;
+    } else {
+        Energy_Sample begin = meter.sample();
+        write_value(package + "/energy_uj", "100000");
+        write_value(dram + "/energy_uj", "501000");
+        Energy_Reading r = meter.measure(begin, meter.sample());
+        failed += check_joules("energy meter, package wraparound", r.joules[ENERGY_PACKAGE], 0.2);
+        failed += check_joules("energy meter, dram", r.joules[ENERGY_DRAM], 0.5);
+    }
+
+    const char *files[] = {"name", "max_energy_range_uj", "energy_uj"};
+    for (int k = 0; k < 3; k++) {
+        unlink((dram + "/" + files[k]).c_str());
+        unlink((package + "/" + files[k]).c_str());
+    }
+    rmdir(dram.c_str());
+    rmdir(package.c_str());
+    rmdir(root);
+    return failed;
+}
+
+/**
+ * Main function of the verification driver
+ * @param argc
+ * @param argv
+ * @return
+ */
+int main(int argc, char** argv) {
+    string file;
+    vector<string> sizes;
+    vector<double> densities(1, 1.0);
+    vector<int> seeds(1, 1), threads(1, 1), chunks(1, 1), kernels;
+    Verify_Tolerances tol;
+    bool failures_only = false;
+
+    for (int k = 0; k < KERNEL_COUNT; k++) kernels.push_back(k);
+
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+
+        if (arg == "--failures") failures_only = true;
+        else if (arg == "--checks") {
+            int failed = live_model_checks() + energy_checks();
+            printf("%d checks failed\n", failed);
+            return failed ? 1 : 0;
+        }
+        else if (a + 1 >= argc) {
+            cerr << "Missing value for " << arg << endl;
+            exit(EXIT_FAILURE);
+        } else if (arg == "--file") file = argv[++a];
+        else if (arg == "--generate") sizes = split(argv[++a]);
+        else if (arg == "--density") {
+            vector<string> items = split(argv[++a]);
+            densities.clear();
+            for (size_t k = 0; k < items.size(); k++) densities.push_back(atof(items[k].c_str()));
+        } else if (arg == "--seeds") seeds = int_list(argv[++a]);
+        else if (arg == "--threads") threads = int_list(argv[++a]);
+        else if (arg == "--chunks") chunks = int_list(argv[++a]);
+        else if (arg == "--kernels") {
+            vector<string> items = split(argv[++a]);
+            kernels.clear();
+            for (size_t k = 0; k < items.size(); k++) {
+                int kernel = kernel_from_name(items[k]);
+                if (kernel < 0) {
+                    cerr << "Unknown kernel " << items[k] << endl;
+                    exit(EXIT_FAILURE);
+                }
+                kernels.push_back(kernel);
+            }
+        } else if (arg == "--objective-tol") from_string<double>(tol.objective, argv[++a], dec);
+        else if (arg == "--tableau-tol") from_string<double>(tol.tableau, argv[++a], dec);
+        else {
+            cerr << "Unknown option " << arg << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    vector<Family_Problem> problems;
+    if (file.size()) {
+        Family_Problem p;
+        p.name = file;
+        problems.push_back(p);
+    }
+    for (size_t s = 0; s < sizes.size(); s++)
+        for (size_t d = 0; d < densities.size(); d++)
+            for (size_t k = 0; k < seeds.size(); k++) {
+                Family_Problem p;
+                if (sscanf(sizes[s].c_str(), "%dx%d", &p.constraints, &p.variables) != 2 || p.constraints <= 0) {
+                    cerr << "Invalid dimension " << sizes[s] << endl;
+                    exit(EXIT_FAILURE);
+                }
+                p.density = densities[d];
+                p.seed = seeds[k];
+                p.name = sizes[s];
+                problems.push_back(p);
+            }
+
+    if (problems.empty()) {
+        cerr << "Usage: " << argv[0] << " (--file /PATH/MxN | --generate MxN[,MxN...]) [options]" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    int cases = 0, failed = 0, skipped = 0;
+
+    for (size_t p = 0; p < problems.size(); p++) {
+        Family_Problem& prob = problems[p];
+        double **problem;
+        int nL, nC;
+
+        if (prob.constraints) {
+            problem = generate_problem(prob.constraints, prob.variables, prob.density, prob.seed, nL, nC);
+        } else {
+            vector<char> path(prob.name.begin(), prob.name.end());
+            path.push_back('\0');
+            char *args[2] = {0, path.data()};
+            problem = read_data(args, nL, nC);
+        }
+
+        int m = nL - 1, width = nC - 1;
+        double **reference = alocate_matrix(nL, nC), **tableau = alocate_matrix(nL, nC);
+        vector<Pivot> reference_pivots;
+        bool unbounded;
+
+        copy_matrix(reference, problem, nL, nC);
+        reference_simplex(reference, m, width, &reference_pivots, &unbounded);
+
+        for (size_t t = 0; t < threads.size(); t++)
+            for (size_t c = 0; c < chunks.size(); c++)
+                for (size_t k = 0; k < kernels.size(); k++) {
+                    char label[256];
+                    snprintf(label, sizeof (label), "%s density %g seed %u threads %d chunk %d kernel %s",
+                             prob.name.c_str(), prob.density, prob.seed, threads[t], chunks[c], kernel_name(kernels[k]));
+                    cases++;
+
+                    if (unbounded) {
+                        skipped++;
+                        if (!failures_only) printf("%s: SKIP unbounded\n", label);
+                        continue;
+                    }
+
+                    Simplex_Options opt;
+                    vector<Pivot> pivots;
+                    opt.chunk = chunks[c];
+                    opt.kernel = kernels[k];
+                    opt.record = &pivots;
+                    omp_set_num_threads(threads[t]);
+
+                    copy_matrix(tableau, problem, nL, nC);
+                    simplex(tableau, m, width, opt);
+
+                    Verify_Result r = compare_solves(tableau, reference, m, width, pivots, reference_pivots, tol);
+                    if (!r.ok) failed++;
+                    if (!r.ok || !failures_only) printf("%s: %s\n", label, r.report().c_str());
+                }
+
+        delete_matrix(problem, nL);
+        delete_matrix(reference, nL);
+        delete_matrix(tableau, nL);
+    }
+
+    printf("%d cases, %d failed, %d skipped\n", cases, failed, skipped);
+    return failed ? 1 : 0;
+}